@@ -1,26 +1,49 @@
 #pragma once
 #include "Common.h"
 
-void initializeGraph(Graph* myGraph, const string nodeFilePath, const string edgeFilePath, double delta, double sectionLength);
+void initializeGraph(Graph* myGraph, const string binFilePath, const string nodeFilePath, const string edgeFilePath, double delta, double sectionLength, const bool planarFlag, const bool reorderFlag, const bool lazyBoundFlag, const bool labelFlag);
+void readTextGraph(Graph* myGraph, const string nodeFilePath, const string edgeFilePath, const bool planarFlag, const bool reorderFlag);
 string changeIntToStr(int count);
-void setQueryEnv(Graph* myGraph, ReferencePath* referencePath, CompletePath* completePath, string inputFolder, string strCount);
-void setCurrPath(Graph* myGraph, std::vector<Edge>* currentPath, CompletePath* completePath, const unsigned int pos);
-void initializeFirstPath(Graph* myGraph, TraversingPath* path, int currentVertex, std::vector<Edge>& currentPath);
+void initVertexMark(VertexMark* mark, const int numOfVertex);
+void clearVertexMark(VertexMark* mark);
+void setVertexMark(VertexMark* mark, const int vertexID);
+bool isVertexMarked(const VertexMark* mark, const int vertexID);
+void initQueryContext(const Graph* myGraph, QueryContext* context);
+void setQueryEnv(const Graph* myGraph, QueryContext* context, ReferencePath* referencePath, CompletePath* completePath, string inputFolder, string strCount);
+void setCurrPath(QueryContext* context, std::vector<Edge>* currentPath, CompletePath* completePath, const unsigned int pos);
+void initializeFirstPath(QueryContext* context, TraversingPath* path, int currentVertex, std::vector<Edge>& currentPath);
 double realDistance(const double lonDiff, const double latDiff, const double cosLongitude);
+double graphRealDistance(const Graph* myGraph, const double xDiff, const double yDiff, const double y);
 void setReferPathLength(ReferencePath* temPath);
-void filterVertexIsSafeArea(Graph* myGraph, ReferencePath* temPath);
+void setSegmentGrid(const Graph* myGraph, ReferencePath* temPath);
+void setReferPointGrid(const Graph* myGraph, ReferencePath* temPath);
+void filterVertexIsSafeArea(const Graph* myGraph, QueryContext* context, ReferencePath* temPath);
+void setSafeArea(const Graph* myGraph, QueryContext* context);
+int addSafeAreaVertex(const Graph* myGraph, QueryContext* context, const int vertexID);
 double pointToSegDist(const double x, const double y, const double x1, const double y1, const double x2, const double y2);
-void setMinPosAndMaxPos(Graph* myGraph, ReferencePath* temReferPath);
+void setMinPosAndMaxPos(const Graph* myGraph, QueryContext* context, ReferencePath* temReferPath);
 double euc(const double px, const double py, const double qx, const double qy);
-void setReferDFDFlag(Graph* myGraph, ReferencePath* temPath);
-void setDistToRefer(Graph* myGraph, ReferencePath* temPath);
-void setTraversalOrderWeights(Graph* myGraph, ReferencePath* temPath);
-void setEdgeLength(Graph* myGraph, Edge* temEdge);
+void setReferDFDFlag(const Graph* myGraph, QueryContext* context, ReferencePath* temPath);
+void setDistToRefer(const Graph* myGraph, QueryContext* context, ReferencePath* temPath);
+void setTraversalOrderWeights(const Graph* myGraph, QueryContext* context, ReferencePath* temPath);
+void setEdgeLength(const Graph* myGraph, Edge* temEdge);
 void writeSingleRecordToFile(Record record[], const unsigned int recordPos, const string filePath);
 void writeContinuousRecordToFile(Record record[], const unsigned int recordPos, const string filePath, double totalRunTime);
-Edge findEdge(Graph* myGraph, Vertex firstVertex, Vertex secVertex);
-void handleNewPath(Graph* myGraph, TraversingPath* oldPath, TraversingPath* newPath, const int newVertexID);
-bool checkIfAccess(Graph * myGraph, TraversingPath * temPath, const int vertexID);
+unsigned int edgeTableHash(const int firstVertexID, const int secVertexID);
+void setEdgeTable(Graph* myGraph);
+int findEdgeID(const Graph* myGraph, const int firstVertexID, const int secVertexID, bool* forwardFlag);
+Edge findEdge(const Graph* myGraph, const int firstVertexID, const int secVertexID);
+int addPathNode(QueryContext* context, const int parentNode, const int edgeID);
+void getPathEdgeIDs(const QueryContext* context, const TraversingPath* path, std::vector<int>& edgeIDs);
+void getPathEdges(const Graph* myGraph, const QueryContext* context, const TraversingPath* path, std::vector<Edge>& edges);
+void clearPathHeap(QueryContext* context);
+void pushPath(QueryContext* context, const TraversingPath& path);
+TraversingPath* popPath(QueryContext* context);
+void clearPathLabels(QueryContext* context);
+bool addPathLabel(const Graph* myGraph, QueryContext* context, const TraversingPath* path);
+void handleNewPath(const Graph* myGraph, QueryContext* context, TraversingPath* oldPath, TraversingPath* newPath, const int newVertexID, ReferencePath* referencePath);
+void markPathVertices(const Graph* myGraph, QueryContext* context, TraversingPath* temPath);
+bool checkIfAccess(const QueryContext* context, const int vertexID);
 void replacePath(std::vector<Edge>& lastPath, std::vector<Edge>& localPath, const int startPos, const int stopPos);
 void updateLastPath(std::vector<Edge>& lastPath, std::vector<Edge>& temLastPath, double* boundDistance, double* temBoundDistance);
 void initializeLastPath(ReferencePath* referencePath, std::vector<Edge>& lastPath);
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 #include <queue>
+#include <deque>
+#include <memory>
 #include <vector>
 #include <ctime>
 #include <string>
@@ -7,28 +9,63 @@
 using std::string;
 
 
-const int VERTEX_SIZE        = 150000;
-const int EDGE_SIZE          = 150000;
 const int POINT_OF_REFERPATH = 100000;
 
+const char BINARY_GRAPH_MAGIC[8]  = {'C', 'T', 'S', 'S', 'G', 'R', 'P', 'H'};
+const int  BINARY_GRAPH_VERSION   = 4;
+
+const double DISTANCE_ONE_DEGREE = 111111;
+
+const int PATH_HEAP_ARITY = 4;
+
+const int DFD_DIST_BLOCK = 64;
+
+const int EDGE_SAMPLE_BLOCK = 65536;
+
 struct Graph;
+struct BinaryGraphHeader;
+struct EdgeSampleCache;
+struct VertexMark;
 struct Vertex;
+struct SafeArea;
+struct QueryContext;
 struct Edge;
 struct ReferencePath;
 struct CompletePath;
+struct PathNode;
 struct TraversingPath;
+struct PathHeapEntry;
+struct PathLabel;
+struct DFDRow;
+struct UniformGrid;
 struct Sequence;
 struct Point;
+struct TrajPointIter;
 struct Record;
 
 /**
  * The struct of Graph
+ * The road network, which is not changed once it is initialized apart from its edge sample cache, so it can be shared by queries
  * @field edgePos the number of edge in the graph
  * @filed vertexPos The number of vertex in the graph
  * @field edgesVector edge array
- * @field vertexsVector vertex array
+ * @field vertexsVector vertex array, only the data that the searches do not need
+ * @field edgeOfOriginalID internal ID of each edge ID of the input files
+ * @field xOfVertex x of each vertex, the longitude or x in meters if the graph is projected
+ * @field yOfVertex y of each vertex, the latitude or y in meters if the graph is projected
+ * @field adjStart start of the neighbors of vertex v in adjacency, at v, adjStart[vertexPos] is the end of the last vertex
+ * @field adjacency neighbors of all vertices grouped by vertex, the k-th one is stored as the neighbor vertex ID at 2 * k and the ID of the connecting edge at 2 * k + 1
+ * @field edgeTableMask the size of edgeTable minus one, the size is a power of two
+ * @field edgeTable open addressing hash table over the ordered pairs of adjacent vertices, each slot holds the position k of the pair in adjacency, -1 if empty
  * @field delta the query delta entered by the user
  * @field SECTION_LENGTH interpolation length entered by the user
+ * @field lazyBoundFlag indicate whether the road network searches only calculate the lower bound of a new path once it reaches the top of the frontier
+ * @field labelFlag indicate whether roadSimpleQueryPath() drops the paths dominated by the label of another path at the same vertex
+ * @field edgeSampleCache interpolated points of the edges that have been walked so far
+ * @field planarFlag indicate whether the vertices are projected into a local plane in meters, true if projected
+ * @field reorderFlag indicate whether the vertices and edges are renumbered along a Hilbert curve, true if renumbered
+ * @field mappedData the mapped binary graph file that the vertex, edge and adjacency arrays point into, NULL if the graph is read from text files
+ * @field mappedSize the size of the mapped binary graph file
 */
 struct Graph
 {
@@ -36,45 +73,162 @@ struct Graph
 	int     vertexPos;
 	Edge*   edgesVector;
 	Vertex* vertexsVector;
+	int*    edgeOfOriginalID;
+	double* xOfVertex;
+	double* yOfVertex;
+	int*    adjStart;
+	int*    adjacency;
+	unsigned int edgeTableMask;
+	int*    edgeTable;
 	double  delta;
 	double  SECTION_LENGTH;
+	bool    lazyBoundFlag;
+	bool    labelFlag;
+	EdgeSampleCache* edgeSampleCache;
+	bool    planarFlag;
+	bool    reorderFlag;
+	void*   mappedData;
+	size_t  mappedSize;
+};
+
+/**
+ * The struct of EdgeSampleCache
+ * The interpolated points of the edges of a graph, an edge is interpolated in both directions the first time it is walked
+ * @field samples points of edge e, 2 * e from its first vertex, 2 * e + 1 from its second vertex, the last vertex of each direction is excluded, NULL if the edge is not interpolated yet
+ * @field sampleCount the number of points of each direction in samples
+ * @field blocks the arrays that hold the points, a block is never moved, so the points of an edge stay valid while more edges are interpolated
+ * @field blockPos the first unused point of the last block
+ * @field blockFree the number of unused points of the last block
+*/
+struct EdgeSampleCache
+{
+	const Point**       samples;
+	int*                sampleCount;
+	std::vector<Point*> blocks;
+	Point*              blockPos;
+	int                 blockFree;
+};
+
+/**
+ * The struct of BinaryGraphHeader
+ * The start of a binary graph file, which is followed by vertexsVector, xOfVertex, yOfVertex, edgesVector,
+ * adjStart, adjacency, edgeTable and edgeOfOriginalID of the graph in this order,
+ * each array is padded to a multiple of 8 bytes
+ * @field magic BINARY_GRAPH_MAGIC
+ * @field version BINARY_GRAPH_VERSION
+ * @field planarFlag 1 if the vertices are projected into a local plane in meters, 0 otherwise
+ * @field reorderFlag 1 if the vertices and edges are renumbered along a Hilbert curve, 0 otherwise
+ * @field vertexPos the number of vertex in the graph
+ * @field edgePos the number of edge in the graph
+ * @field numOfAdjacency the number of neighbors of all vertices, adjStart[vertexPos]
+ * @field edgeTableSize the number of slots of edgeTable
+ * @field vertexSize sizeof(Vertex) of the program that wrote the file
+ * @field edgeSize sizeof(Edge) of the program that wrote the file
+*/
+struct BinaryGraphHeader
+{
+	char magic[8];
+	int  version;
+	int  planarFlag;
+	int  reorderFlag;
+	int  vertexPos;
+	int  edgePos;
+	int  numOfAdjacency;
+	int  edgeTableSize;
+	int  vertexSize;
+	int  edgeSize;
+};
+
+/**
+ * The struct of VertexMark
+ * A set of marked vertices that is cleared in O(1) by starting a new generation
+ * @field generation the current generation, a vertex is marked if its stamp equals it
+ * @field stamps the generation in which each vertex was last marked
+*/
+struct VertexMark
+{
+	unsigned int generation;
+	std::vector<unsigned int> stamps;
 };
 
 /**
  * The struct of Vertex
- * @field vertexID ID of this vertex
- * @field minPos minPos related to the reference path
- * @field maxPos maxPos related to the reference path
+ * The coordinates of the vertices are kept in separate arrays of the graph
+ * @field vertexID ID of this vertex in the input files, which is kept if the vertices are renumbered
+*/
+struct Vertex
+{
+	int vertexID;
+};
+
+/**
+ * The struct of SafeArea
+ * The vertices in the safe area of a query and the edges between them, with the vertices numbered densely from 0,
+ * so that the searches walk a small adjacency instead of the whole graph
+ * A neighbor is stored with its ID in the graph, as everything else a query keeps is indexed by it
+ * @field globalVertexID ID in the graph of each vertex of the safe area
+ * @field localVertexID ID in the safe area of each vertex of the graph, -1 if it is not in the safe area
+ * @field xOfVertex x of each vertex of the safe area
+ * @field yOfVertex y of each vertex of the safe area
+ * @field adjStart start of the neighbors of safe area vertex v in adjacency, at v, the last entry is the end of the last vertex
+ * @field adjacency neighbors in the safe area, the k-th one is stored as the neighbor vertex ID in the graph at 2 * k and the ID of the connecting edge at 2 * k + 1
+*/
+struct SafeArea
+{
+	std::vector<int>    globalVertexID;
+	std::vector<int>    localVertexID;
+	std::vector<double> xOfVertex;
+	std::vector<double> yOfVertex;
+	std::vector<int>    adjStart;
+	std::vector<int>    adjacency;
+};
+
+/**
+ * The struct of QueryContext
+ * Everything a query writes while it runs, so that queries on different threads can share one graph
+ * as long as each of them has its own context, a context is reused by the queries run one after another
+ * Each field holds one value per vertex in its own array, so a sweep over all vertices only reads the arrays it uses
+ * @field minPos minPos of each vertex related to the reference path
+ * @field maxPos maxPos of each vertex related to the reference path
  * @field parentVertexID used to store the id of the parent node when searching similar to bfs
- * @field referFlag indicate whether the vertex is on the reference path, true if located
- * @field locationFlag indicate whether the vertex is in a safe area, true if located
- * @field accessFlag indicate whether the vertex has been visited, true if visited
- * @field currFlag indicate whether the vertex is on the current path, true if located
- * @field longitude the longitude of the vertex
- * @field latitude the latitude of the vertex
- * @field distToRefer the shortest distance from this vertex to the reference path
- * @field eucLengthToFinalVertex Euclidean distance to the end of the reference path
+ * @field distToRefer the shortest distance from each vertex to the reference path
+ * @field eucLengthToFinalVertex Euclidean distance from each vertex to the end of the reference path
  * @field traversalOrderWeights weight of each vertex during extension
- * @field adjVertexID the ID of the vertex adjacent to the vertex
- * @field adjEdgeID the IDof the edge adjacent to the vertex
+ * @field referMark marks the vertices on the reference path
+ * @field locationMark marks the vertices in the safe area
+ * @field accessMark marks the vertices that have been visited
+ * @field currMark marks the vertices on the current path
+ * @field searchMark marks the vertices reached by a search similar to bfs
+ * @field lastPathMark marks the vertices on the lastPath during maxmalOverlapPath()
+ * @field pathMark marks the vertices on the traversing path that is being expanded
+ * @field labelMark marks the vertices of a path whose label is compared in addPathLabel()
+ * @field safeArea the subgraph of the vertices marked in locationMark
+ * @field pathTree the edges of the traversing paths of the current search, a path is its last node and the chain of parents
+ * @field pathArena the traversing paths pushed during the current search, a path keeps its position until the arena is cleared
+ * @field pathHeap the frontier of the current search, a PATH_HEAP_ARITY-ary min heap over the paths in pathArena
+ * @field pathLabels the labels of the paths pushed by the current search, one set per vertex of the safe area subgraph
 */
-struct Vertex
+struct QueryContext
 {
-	int    vertexID;
-	int    minPos;
-	int    maxPos;
-	int    parentVertexID;
-	bool   referFlag;
-	bool   locationFlag;
-	bool   accessFlag;
-	bool   currFlag;
-	double longitude;
-	double latitude;
-	double distToRefer;
-	double eucLengthToFinalVertex;
-	double traversalOrderWeights;
-	std::vector<int> adjVertexID;
-	std::vector<int> adjEdgeID;
+	std::vector<int>    minPos;
+	std::vector<int>    maxPos;
+	std::vector<int>    parentVertexID;
+	std::vector<double> distToRefer;
+	std::vector<double> eucLengthToFinalVertex;
+	std::vector<double> traversalOrderWeights;
+	VertexMark referMark;
+	VertexMark locationMark;
+	VertexMark accessMark;
+	VertexMark currMark;
+	VertexMark searchMark;
+	VertexMark lastPathMark;
+	VertexMark pathMark;
+	VertexMark labelMark;
+	SafeArea   safeArea;
+	std::vector<PathNode> pathTree;
+	std::deque<TraversingPath>  pathArena;
+	std::vector<PathHeapEntry>  pathHeap;
+	std::vector<std::vector<PathLabel> > pathLabels;
 };
 
 /**
@@ -94,6 +248,32 @@ struct Edge
 	double realLength;
 };
 
+/**
+ * The struct of UniformGrid
+ * A uniform grid over the items of the reference path, each cell lists the items whose bounding box overlaps the cell
+ * @field minX x of the lower left corner of the grid
+ * @field minY y of the lower left corner of the grid
+ * @field maxX x of the upper right corner of the bounding box of all items
+ * @field maxY y of the upper right corner of the bounding box of all items
+ * @field cellSize side length of a cell
+ * @field numOfCol number of columns of the grid
+ * @field numOfRow number of rows of the grid
+ * @field cellStart start of the items of the cell in row r and column c in cellItems, at r * numOfCol + c
+ * @field cellItems position of the items in the reference path, grouped by cell and increasing in each cell
+*/
+struct UniformGrid
+{
+	double minX;
+	double minY;
+	double maxX;
+	double maxY;
+	double cellSize;
+	int    numOfCol;
+	int    numOfRow;
+	std::vector<int> cellStart;
+	std::vector<int> cellItems;
+};
+
 /**
  * The struct of ReferencePath
  * @field initialVertex start vertex of reference path
@@ -101,8 +281,12 @@ struct Edge
  * @field numOfReferPoint number of trajectory points after reference path interpolation
  * @field referDFDFlag calculated sign at the end of the reference path
  * @field pointOfRefer trajectory point array
+ * @field xOfRefer x of the trajectory points, stored separately for the vectorized dfd
+ * @field yOfRefer y of the trajectory points, stored separately for the vectorized dfd
  * @field referenceLength the total length of the reference path
  * @field edges included edges of the reference path
+ * @field segmentGrid uniform grid over the edges of the reference path, whose bounding boxes are expanded by a little more than delta
+ * @field pointGrid uniform grid over the trajectory points of the reference path
 */
 struct ReferencePath
 {
@@ -111,8 +295,12 @@ struct ReferencePath
 	int    numOfReferPoint;
 	bool   referDFDFlag;
 	Point* pointOfRefer;
+	std::vector<double> xOfRefer;
+	std::vector<double> yOfRefer;
 	double referenceLength;
 	std::vector<Edge> edges;
+	UniformGrid segmentGrid;
+	UniformGrid pointGrid;
 };
 
 /**
@@ -130,6 +318,19 @@ struct CompletePath
 	std::vector<Edge> edges;
 };
 
+/**
+ * The struct of PathNode
+ * One edge of a traversing path in the path tree of a query context,
+ * a path that is extended shares all the nodes of the old path instead of copying its edges
+ * @field parentNode position of the node of the previous edge in the path tree, -1 for the first edge of the path
+ * @field edgeID ID of the edge
+*/
+struct PathNode
+{
+	int parentNode;
+	int edgeID;
+};
+
 /**
  * The struct of TraversingPath
  * @field minPos minPos of the traversing path
@@ -138,8 +339,12 @@ struct CompletePath
  * @field traversingPathID ID of the traversing path
  * @field distToRefer the distance from the traversing path to the reference path
  * @field eucDelta lb of the path
- * @field eucDeltaOfTrue true lb of the path
- * @field edges included edges of the traversing path
+ * @field eucDeltaOfTrue true lb of the path, only an estimate that is not larger if exactBoundFlag is false
+ * @field exactBoundFlag indicate whether dfdRow includes the last edge and eucDeltaOfTrue is calculated by calculateLowerBound(),
+ *                       false if both are left to settleLowerBound() in lazy bound mode
+ * @field lastNode position of the node of the last edge in the path tree of the query context, -1 if the path has no edge
+ * @field numOfEdge the number of edges of the traversing path
+ * @field dfdRow last banded dfd row of the path (without its final vertex) against the reference path, shared with extended paths
 */
 struct TraversingPath
 {
@@ -150,11 +355,58 @@ struct TraversingPath
 	double distToRefer;
 	double eucDelta;
 	double eucDeltaOfTrue;
-	std::vector<int> edges;
-	bool operator<(const TraversingPath path) const
-	{
-		return this->eucDelta > path.eucDelta;
-	}
+	bool   exactBoundFlag;
+	int    lastNode;
+	int    numOfEdge;
+	std::shared_ptr<const DFDRow> dfdRow;
+};
+
+/**
+ * The struct of PathHeapEntry
+ * An entry of the search frontier, the path itself stays in the path arena of the query context
+ * Entries with the same key are popped in the order in which they are pushed
+ * @field key eucDelta of the path
+ * @field pathIndex position of the path in the path arena
+*/
+struct PathHeapEntry
+{
+	double key;
+	int    pathIndex;
+};
+
+/**
+ * The struct of PathLabel
+ * The state of a traversing path at its final vertex, which decides how the path can go on
+ * A label dominates another one at the same vertex if none of its fields is worse
+ * and its path visits no vertex that the other path does not visit
+ * @field lastNode the last node of the path in the path tree, through which its vertices are walked
+ * @field minPos minPos of the path
+ * @field distToRefer distToRefer of the path
+ * @field lowerBound eucDeltaOfTrue of the path
+ * @field dfdRow dfd row of the path, it dominates if none of its cells is larger
+*/
+struct PathLabel
+{
+	int    lastNode;
+	int    minPos;
+	double distToRefer;
+	double lowerBound;
+	std::shared_ptr<const DFDRow> dfdRow;
+};
+
+/**
+ * The struct of DFDRow
+ * The last row of the dfd matrix between a trajectory prefix and the second trajectory,
+ * only the band of cells that can be within delta is stored
+ * @field lo position of the first stored cell in the second trajectory
+ * @field numOfPoint number of points of the first trajectory appended to the row, 0 if the row is not started
+ * @field cells the cells from lo on, the first and last ones are within delta, the others exceeding delta are DBL_MAX
+*/
+struct DFDRow
+{
+	int lo;
+	int numOfPoint;
+	std::vector<double> cells;
 };
 
 /**
@@ -181,6 +433,34 @@ struct Point
 	double y;
 };
 
+/**
+ * The struct of TrajPointIter
+ * Walks the discrete points of a path in the order of creatTrajPoint() without building them
+ * @field myGraph the graph whose edge sample cache provides the points
+ * @field edges edges of the path, NULL if the path is given by edgeIDs
+ * @field edgeIDs ID of the edges of the path, NULL if the path is given by edges
+ * @field edgeCount the number of edges of the path
+ * @field edgePos position of the next edge to be walked
+ * @field currVertexID the vertex from which the next edge is traversed
+ * @field withFinal whether the final vertex of the path is yielded after the last edge
+ * @field finished indicate whether all points have been yielded
+ * @field samplePos next point of the current edge
+ * @field sampleStop end of the points of the current edge
+*/
+struct TrajPointIter
+{
+	const Graph* myGraph;
+	const Edge*  edges;
+	const int*   edgeIDs;
+	int          edgeCount;
+	int          edgePos;
+	int          currVertexID;
+	bool         withFinal;
+	bool         finished;
+	const Point* samplePos;
+	const Point* sampleStop;
+};
+
 /**
  * The struct of Record
  * @field numDFDCal calculation times of DFD
@@ -3,5 +3,9 @@
 
 void readVertexs(Graph* myGraph, const std::string nodeFilePath);
 void readEdges(Graph* myGraph, const std::string edgeFilePath);
-void readReferencePath(Graph* myGraph, ReferencePath* referencePath, const std::string referFilePath);
-void readCompletePath(Graph * myGraph, CompletePath * completePath, const std::string comFilePath); 
+void setAdjacency(Graph* myGraph);
+void reorderGraph(Graph* myGraph);
+void readReferencePath(const Graph* myGraph, QueryContext* context, ReferencePath* referencePath, const std::string referFilePath);
+void readCompletePath(const Graph* myGraph, CompletePath * completePath, const std::string comFilePath); 
+bool writeBinaryGraph(const Graph* myGraph, const std::string binFilePath);
+bool mapBinaryGraph(Graph* myGraph, const std::string binFilePath, const bool planarFlag, const bool reorderFlag);
@@ -1,5 +1,9 @@
 #pragma once
 #include "Common.h"
 
-void discreteReferPath(Graph* myGraph, ReferencePath* temPath);
-std::vector<Point> creatTrajPoint(Graph * myGraph, std::vector<Edge>& temPath, int initialVertex);
+void discreteReferPath(const Graph* myGraph, ReferencePath* temPath);
+std::vector<Point> creatTrajPoint(const Graph* myGraph, std::vector<Edge>& temPath, int initialVertex);
+void initEdgeSamples(Graph* myGraph);
+void initTrajPointIter(TrajPointIter* iter, const Graph* myGraph, const Edge* edges, const int edgeCount, const int initialVertex, const bool withFinal);
+void initTrajPointIterByID(TrajPointIter* iter, const Graph* myGraph, const int* edgeIDs, const int edgeCount, const int initialVertex, const bool withFinal);
+bool nextTrajPoint(TrajPointIter* iter, Point* temPoint);
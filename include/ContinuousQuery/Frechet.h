@@ -1,7 +1,13 @@
 #pragma once
 #include "Common.h"
 
-double dfdDist(const int m, const int n, Point* p, Point* q);
-double dfdDistBetweenTwoPaths(Graph* myGraph, TraversingPath* temPath, ReferencePath* referencePath, std::vector<Edge>& lastPath, int finalVertexID);
-double DFD(Graph * myGraph, std::vector<Edge> finalPath, ReferencePath * referencePath);
-double dfdBetweenTwoLocalPaths(Graph* myGraph, std::vector<Edge>& firstPath, std::vector<Edge>& secPath, int initialVertex);
\ No newline at end of file
+double dfdDistSeq(const int m, const int n, const double* px, const double* py, const double* qx, const double* qy);
+void pointDistances(const Point& pt, const int count, const double* qx, const double* qy, double* dist);
+void extendDFDRow(DFDRow& row, const int m, Point* p, const int n, const double* qx, const double* qy, const double delta);
+double dfdRowCell(const DFDRow& row, const int j);
+bool dfdRowDominates(const DFDRow& first, const DFDRow& second);
+double dfdBetweenTwoLocalPaths(const Graph* myGraph, std::vector<Edge>& firstPath, std::vector<Edge>& secPath, int initialVertex);
+double dfdWithinBetweenTwoPaths(const Graph* myGraph, const QueryContext* context, TraversingPath* temPath, ReferencePath* referencePath, std::vector<Edge>& lastPath, int finalVertexID);
+double DFDWithin(const Graph* myGraph, std::vector<Edge>& finalPath, ReferencePath* referencePath, const bool distFlag);
+void setPathDFDRow(const Graph* myGraph, const QueryContext* context, TraversingPath* temPath, ReferencePath* referencePath);
+void extendPathDFDRow(const Graph* myGraph, const QueryContext* context, TraversingPath* temPath, ReferencePath* referencePath, const int initialVertex);
\ No newline at end of file
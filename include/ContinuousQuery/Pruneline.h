@@ -1,12 +1,12 @@
 #pragma once
 #include "Common.h"
 
-bool eucSimpleQueryPath(Graph* myGraph, ReferencePath* referencePath, std::vector<Edge> currentPath, Record* temRecord, int currentVertex);
+bool eucSimpleQueryPath(const Graph* myGraph, QueryContext* context, ReferencePath* referencePath, std::vector<Edge> currentPath, Record* temRecord, int currentVertex);
 
-bool roadSimpleQueryPath(Graph* myGraph, ReferencePath* referencePath, std::vector<Edge> currentPath, 
+bool roadSimpleQueryPath(const Graph* myGraph, QueryContext* context, ReferencePath* referencePath, std::vector<Edge> currentPath, 
 	std::vector<Edge>& lastPath, Record* temRecord, int currentVertex, int* timeOutFlag, double* pathDistance);
 
-bool roadSimleQueryPathWithLoop(Graph * myGraph, ReferencePath * referencePath, std::vector<Edge> currentPath, 
+bool roadSimleQueryPathWithLoop(const Graph* myGraph, QueryContext* context, ReferencePath * referencePath, std::vector<Edge> currentPath, 
 	std::vector<Edge>& lastPath, Record * temRecord, int currentVertex, int* timeOutFlag, double* pathDistance);
 
-void maxmalOverlapPath(Graph* myGraph, std::vector<Edge>& localPath, std::vector<Edge>& lastPath, int firstVertexID, int secVertexID, int* endVertexID);
\ No newline at end of file
+void maxmalOverlapPath(const Graph* myGraph, QueryContext* context, std::vector<Edge>& localPath, std::vector<Edge>& lastPath, int firstVertexID, int secVertexID, int* endVertexID);
\ No newline at end of file
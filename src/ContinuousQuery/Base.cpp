@@ -7,6 +7,7 @@
 #include <ctime>
 #include <float.h>
 #include <limits>
+#include <algorithm>
 
 #include "../../include/ContinuousQuery/Base.h"
 #include "../../include/ContinuousQuery/Common.h"
@@ -33,19 +34,17 @@ double getPathLength(const std::vector<Edge>& temPath)
 }
 
 /**
- * Reset the flags of all vertices in the graph
- * @param myGraph pointer to a graph
+ * Reset the marks of all vertices in a query context
+ * Each mark starts a new generation, so the cost does not depend on the size of the graph
+ * @param context pointer to a query context
 */
-void resetVertexFlag(Graph* myGraph)
+void resetVertexFlag(QueryContext* context)
 {
 	printf("Reset the flag of the vertex of the road network...\n");
-	for (unsigned int i = 0; i < (myGraph->vertexPos); i++)
-	{
-		myGraph->vertexsVector[i].referFlag    = false;
-		myGraph->vertexsVector[i].locationFlag = false;
-		myGraph->vertexsVector[i].accessFlag   = false;
-		myGraph->vertexsVector[i].currFlag     = false;
-	}
+	clearVertexMark(&context->referMark);
+	clearVertexMark(&context->locationMark);
+	clearVertexMark(&context->accessMark);
+	clearVertexMark(&context->currMark);
 	printf("The flag of the vertex of the road network is set!!!\n");
 }
 
@@ -120,22 +119,26 @@ void setComInitialAndFinal(CompletePath* temPath)
 /**
  * Initialize the reference path
  * @param myGraph pointer to a graph
+ * @param context pointer to the query context filled in for the reference path
  * @param temReferPath pointer to a reference path
  * @param referFilePath file path of reference path
 */
-void initializeReferencePath(Graph* myGraph, ReferencePath* temReferPath, const string referFilePath)
+void initializeReferencePath(const Graph* myGraph, QueryContext* context, ReferencePath* temReferPath, const string referFilePath)
 {
 	printf("Initializing reference path...\n");
 	temReferPath->pointOfRefer = new Point[POINT_OF_REFERPATH];
-	readReferencePath(myGraph, temReferPath, referFilePath);
+	readReferencePath(myGraph, context, temReferPath, referFilePath);
 	setReferInitialAndFinal(temReferPath);
 	discreteReferPath(myGraph, temReferPath);
-	setReferDFDFlag(myGraph, temReferPath);
+	setReferPointGrid(myGraph, temReferPath);
+	setReferDFDFlag(myGraph, context, temReferPath);
 	temReferPath->referenceLength = getPathLength(temReferPath->edges);
-	filterVertexIsSafeArea(myGraph, temReferPath);
-	setMinPosAndMaxPos(myGraph, temReferPath);
-	setDistToRefer(myGraph, temReferPath);
-	setTraversalOrderWeights(myGraph, temReferPath);
+	setSegmentGrid(myGraph, temReferPath);
+	filterVertexIsSafeArea(myGraph, context, temReferPath);
+	setSafeArea(myGraph, context);
+	setMinPosAndMaxPos(myGraph, context, temReferPath);
+	setDistToRefer(myGraph, context, temReferPath);
+	setTraversalOrderWeights(myGraph, context, temReferPath);
 	printf("The reference path is initialized!!!\n");
 }
 
@@ -145,7 +148,7 @@ void initializeReferencePath(Graph* myGraph, ReferencePath* temReferPath, const
  * @param temComPath pointer to a complete path
  * @param comFilePath file path of complete path
 */
-void initializeCompletePath(Graph* myGraph, CompletePath* temComPath, const string comFilePath)
+void initializeCompletePath(const Graph* myGraph, CompletePath* temComPath, const string comFilePath)
 {
 	printf("Initialzing complete path...\n");
 	readCompletePath(myGraph, temComPath, comFilePath);
@@ -154,28 +157,374 @@ void initializeCompletePath(Graph* myGraph, CompletePath* temComPath, const stri
 	printf("The complete path is initialized...\n");
 }
 
+/**
+ * Project every vertex into a local plane in meters
+ * The projection is equirectangular around the centroid of the vertices, so that
+ * distances on the plane are plain Euclidean distances and no trig is needed afterwards
+ * @param myGraph pointer to a graph
+*/
+void projectVertexs(Graph* myGraph)
+{
+	printf("Projecting the vertices into a local plane...\n");
+	if (myGraph->vertexPos == 0)
+	{
+		return;
+	}
+	double centerLon = 0.0;
+	double centerLat = 0.0;
+	for (int i = 0; i < myGraph->vertexPos; i++)
+	{
+		centerLon += myGraph->xOfVertex[i];
+		centerLat += myGraph->yOfVertex[i];
+	}
+	centerLon /= myGraph->vertexPos;
+	centerLat /= myGraph->vertexPos;
+	const double xScale = DISTANCE_ONE_DEGREE * cos(centerLat * M_PI / 180.0);
+	const double yScale = DISTANCE_ONE_DEGREE;
+	for (int i = 0; i < myGraph->vertexPos; i++)
+	{
+		myGraph->xOfVertex[i] = (myGraph->xOfVertex[i] - centerLon) * xScale;
+		myGraph->yOfVertex[i] = (myGraph->yOfVertex[i] - centerLat) * yScale;
+	}
+	printf("The vertices are projected around (%lf, %lf)!!!\n", centerLat, centerLon);
+}
+
+
+/**
+ * Get the column or row of the grid cell that a coordinate falls in
+ * Coordinates outside the grid are clamped to its border cells
+ * @param value the coordinate
+ * @param minValue the coordinate of the lower left corner of the grid
+ * @param cellSize side length of a cell
+ * @param numOfCell number of columns or rows of the grid
+ * @return the column or row of the cell
+*/
+int gridCellPos(const double value, const double minValue, const double cellSize, const int numOfCell)
+{
+	double pos = floor((value - minValue) / cellSize);
+	if (pos < 0)
+	{
+		return 0;
+	}
+	if (pos > numOfCell - 1)
+	{
+		return numOfCell - 1;
+	}
+	return (int)pos;
+}
+
+/**
+ * Calculate the shortest distance from a point to the rectangle of a block of grid cells
+ * @param grid the grid
+ * @param x x of the point
+ * @param y y of the point
+ * @param firstCol first column of the block
+ * @param lastCol last column of the block
+ * @param firstRow first row of the block
+ * @param lastRow last row of the block
+ * @return the shortest distance, DBL_MAX if the block is empty
+*/
+double pointToCellsDist(const UniformGrid& grid, const double x, const double y, const int firstCol, const int lastCol, const int firstRow, const int lastRow)
+{
+	if ((firstCol > lastCol) || (firstRow > lastRow))
+	{
+		return DBL_MAX;
+	}
+	double x1 = grid.minX + firstCol * grid.cellSize;
+	double x2 = grid.minX + (lastCol + 1) * grid.cellSize;
+	double y1 = grid.minY + firstRow * grid.cellSize;
+	double y2 = grid.minY + (lastRow + 1) * grid.cellSize;
+	double dx = x < x1 ? x1 - x : (x > x2 ? x - x2 : 0.0);
+	double dy = y < y1 ? y1 - y : (y > y2 ? y - y2 : 0.0);
+	return sqrt(dx * dx + dy * dy);
+}
+
+/**
+ * Calculate a little more than delta, so that rounding can never make an item within delta fall outside the searched cells
+ * @param delta the query delta
+ * @param scale the largest magnitude of the coordinates involved
+ * @return the padded delta
+*/
+double gridPad(const double delta, const double scale)
+{
+	return delta + 1e-6 * (delta + scale);
+}
+
+/**
+ * Fill a uniform grid with items given by their bounding boxes
+ * The cells are about cellSize wide, but the grid is coarsened when there would be too many cells
+ * @param grid the grid, this variable is the return value
+ * @param boxMin lower left corner of the bounding box of each item
+ * @param boxMax upper right corner of the bounding box of each item
+ * @param cellSize the preferred side length of a cell
+*/
+void fillGrid(UniformGrid& grid, const std::vector<Point>& boxMin, const std::vector<Point>& boxMax, const double cellSize)
+{
+	const int numOfItem = boxMin.size();
+	grid.minX = DBL_MAX;
+	grid.minY = DBL_MAX;
+	grid.maxX = -DBL_MAX;
+	grid.maxY = -DBL_MAX;
+	for (int i = 0; i < numOfItem; i++)
+	{
+		grid.minX = (std::min)(grid.minX, boxMin[i].x);
+		grid.minY = (std::min)(grid.minY, boxMin[i].y);
+		grid.maxX = (std::max)(grid.maxX, boxMax[i].x);
+		grid.maxY = (std::max)(grid.maxY, boxMax[i].y);
+	}
+	if (numOfItem == 0)
+	{
+		grid.minX = grid.minY = grid.maxX = grid.maxY = 0.0;
+	}
+	const double extent       = (std::max)(grid.maxX - grid.minX, grid.maxY - grid.minY);
+	const double maxNumOfCell = (std::max)(1024, 4 * numOfItem);
+	grid.cellSize = cellSize;
+	if ((grid.cellSize <= 0) || ((extent / grid.cellSize) * (extent / grid.cellSize) > maxNumOfCell))
+	{
+		grid.cellSize = extent / sqrt(maxNumOfCell);
+	}
+	if (grid.cellSize <= 0)
+	{
+		grid.cellSize = 1.0;
+	}
+	grid.numOfCol = (int)((grid.maxX - grid.minX) / grid.cellSize) + 1;
+	grid.numOfRow = (int)((grid.maxY - grid.minY) / grid.cellSize) + 1;
+
+	// count the items of each cell first, then fill them in
+	grid.cellStart.assign(grid.numOfCol * grid.numOfRow + 1, 0);
+	for (int pass = 0; pass < 2; pass++)
+	{
+		std::vector<int> cellPos(grid.cellStart.begin(), grid.cellStart.end() - 1);
+		for (int i = 0; i < numOfItem; i++)
+		{
+			int firstCol = gridCellPos(boxMin[i].x, grid.minX, grid.cellSize, grid.numOfCol);
+			int lastCol  = gridCellPos(boxMax[i].x, grid.minX, grid.cellSize, grid.numOfCol);
+			int firstRow = gridCellPos(boxMin[i].y, grid.minY, grid.cellSize, grid.numOfRow);
+			int lastRow  = gridCellPos(boxMax[i].y, grid.minY, grid.cellSize, grid.numOfRow);
+			for (int r = firstRow; r <= lastRow; r++)
+			{
+				for (int c = firstCol; c <= lastCol; c++)
+				{
+					if (pass == 0)
+					{
+						grid.cellStart[r * grid.numOfCol + c + 1]++;
+					}
+					else
+					{
+						grid.cellItems[cellPos[r * grid.numOfCol + c]++] = i;
+					}
+				}
+			}
+		}
+		if (pass == 0)
+		{
+			for (unsigned int j = 1; j < grid.cellStart.size(); j++)
+			{
+				grid.cellStart[j] += grid.cellStart[j - 1];
+			}
+			grid.cellItems.resize(grid.cellStart.back());
+		}
+	}
+}
+
+/**
+ * Find the trajectory points of the reference path within delta of a point
+ * Only the cells of the point grid that overlap the square of a little more than delta around the point are searched
+ * @param myGraph pointer to a graph
+ * @param temPath pointer to a reference path
+ * @param x x of the point
+ * @param y y of the point
+ * @param lo the first position of the trajectory points to be considered
+ * @param hi the last position of the trajectory points to be considered
+ * @param minPos the first position within delta, unchanged if there is none, this variable is the return value
+ * @param maxPos the last position within delta, unchanged if there is none, this variable is the return value
+ * @return the number of trajectory points in [lo, hi] within delta
+*/
+int findReferPointWithin(const Graph* myGraph, ReferencePath* temPath, const double x, const double y, const int lo, const int hi, int* minPos, int* maxPos)
+{
+	const UniformGrid& grid = temPath->pointGrid;
+	double pad = gridPad(myGraph->delta, fabs(x) + fabs(y));
+	if ((x + pad < grid.minX) || (x - pad > grid.maxX) || (y + pad < grid.minY) || (y - pad > grid.maxY))
+	{
+		return 0;
+	}
+	int firstCol = gridCellPos(x - pad, grid.minX, grid.cellSize, grid.numOfCol);
+	int lastCol  = gridCellPos(x + pad, grid.minX, grid.cellSize, grid.numOfCol);
+	int firstRow = gridCellPos(y - pad, grid.minY, grid.cellSize, grid.numOfRow);
+	int lastRow  = gridCellPos(y + pad, grid.minY, grid.cellSize, grid.numOfRow);
+	int count = 0;
+	int first = hi + 1;
+	int last  = lo - 1;
+	for (int r = firstRow; r <= lastRow; r++)
+	{
+		for (int c = firstCol; c <= lastCol; c++)
+		{
+			int cell = r * grid.numOfCol + c;
+			for (int j = grid.cellStart[cell]; j < grid.cellStart[cell + 1]; j++)
+			{
+				int pos = grid.cellItems[j];
+				if ((pos < lo) || (pos > hi))
+				{
+					continue;
+				}
+				if (euc(x, y, temPath->pointOfRefer[pos].x, temPath->pointOfRefer[pos].y) <= (myGraph->delta))
+				{
+					first = (std::min)(first, pos);
+					last  = (std::max)(last, pos);
+					count++;
+				}
+			}
+		}
+	}
+	if (count > 0)
+	{
+		*minPos = first;
+		*maxPos = last;
+	}
+	return count;
 }
 
 /**
- * Initialize a graph using vertex file path, edge file path and delta
+ * Calculate the shortest distance from a point to an edge of the reference path
  * @param myGraph pointer to a graph
+ * @param temPath pointer to a reference path
+ * @param x x of the point
+ * @param y y of the point
+ * @param pos position of the edge in the reference path
+ * @return the shortest distance from the point to the edge
+*/
+double pointToReferEdgeDist(const Graph* myGraph, ReferencePath* temPath, const double x, const double y, const int pos)
+{
+	double x1 = myGraph->xOfVertex[temPath->edges[pos].firstVertexID];
+	double y1 = myGraph->yOfVertex[temPath->edges[pos].firstVertexID];
+	double x2 = myGraph->xOfVertex[temPath->edges[pos].secVertexID];
+	double y2 = myGraph->yOfVertex[temPath->edges[pos].secVertexID];
+	return pointToSegDist(x, y, x1, y1, x2, y2);
+}
+
+/**
+ * Order of two entries of the path heap
+ * @param first an entry of the path heap
+ * @param second another entry of the path heap
+ * @return true if first is popped before second
+*/
+bool pathHeapLess(const PathHeapEntry& first, const PathHeapEntry& second)
+{
+	if (first.key != second.key)
+	{
+		return first.key < second.key;
+	}
+	return first.pathIndex < second.pathIndex;
+}
+
+/**
+ * Decide whether a path label dominates another one at the same vertex
+ * @param first the label that may dominate
+ * @param second the other label
+ * @return true if no field of first is worse than the same field of second
+*/
+bool pathLabelDominates(const PathLabel& first, const PathLabel& second)
+{
+	return (first.minPos <= second.minPos) && (first.distToRefer <= second.distToRefer)
+		&& (first.lowerBound <= second.lowerBound) && dfdRowDominates(*(first.dfdRow), *(second.dfdRow));
+}
+
+/**
+ * Mark the vertices of a path of the path tree
+ * @param myGraph pointer to a graph
+ * @param context pointer to the query context that holds the path tree
+ * @param mark the mark to be cleared and set
+ * @param lastNode the last node of the path
+*/
+void markPathNodeVertices(const Graph* myGraph, const QueryContext* context, VertexMark* mark, const int lastNode)
+{
+	clearVertexMark(mark);
+	for (int node = lastNode; node != -1; node = context->pathTree[node].parentNode)
+	{
+		const Edge& temEdge = myGraph->edgesVector[context->pathTree[node].edgeID];
+		setVertexMark(mark, temEdge.firstVertexID);
+		setVertexMark(mark, temEdge.secVertexID);
+	}
+}
+
+/**
+ * Decide whether all vertices of a path of the path tree are marked
+ * @param myGraph pointer to a graph
+ * @param context pointer to the query context that holds the path tree
+ * @param mark the mark set by markPathNodeVertices()
+ * @param lastNode the last node of the path
+ * @return true if no vertex of the path is unmarked
+*/
+bool pathNodeVerticesMarked(const Graph* myGraph, const QueryContext* context, const VertexMark* mark, const int lastNode)
+{
+	for (int node = lastNode; node != -1; node = context->pathTree[node].parentNode)
+	{
+		const Edge& temEdge = myGraph->edgesVector[context->pathTree[node].edgeID];
+		if (!isVertexMarked(mark, temEdge.firstVertexID) || !isVertexMarked(mark, temEdge.secVertexID))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+/**
+ * Initialize a graph using the binary graph file, or the vertex file and edge file if it cannot be used, and delta
+ * @param myGraph pointer to a graph
+ * @param binFilePath the file path of the binary graph file written by CTSSConvert
  * @param nodeFilePath the file path of the vertex file
  * @param edgeFilePath the file path of the edge file
- * @param delta delta of this group of queries
+ * @param delta delta of this group of queries, in meters if the graph is projected
  * @param sectionLength interpolation length used during interpolation
+ * @param planarFlag whether the vertices are projected into a local plane in meters
+ * @param reorderFlag whether the vertices and edges are renumbered along a Hilbert curve
+ * @param lazyBoundFlag whether the road network searches calculate the lower bound of a new path lazily
+ * @param labelFlag whether the simple path search drops paths dominated by the label of another path
 */
-void initializeGraph(Graph* myGraph, const string nodeFilePath, const string edgeFilePath, double delta, double sectionLength)
+void initializeGraph(Graph* myGraph, const string binFilePath, const string nodeFilePath, const string edgeFilePath, double delta, double sectionLength, const bool planarFlag, const bool reorderFlag, const bool lazyBoundFlag, const bool labelFlag)
 {
 	printf("Initializing the road network...\n");
-	myGraph->vertexsVector = new Vertex[VERTEX_SIZE];
-	myGraph->edgesVector   = new Edge[EDGE_SIZE];
-	readVertexs(myGraph, nodeFilePath);
-	readEdges(myGraph, edgeFilePath);
+	if (!mapBinaryGraph(myGraph, binFilePath, planarFlag, reorderFlag))
+	{
+		readTextGraph(myGraph, nodeFilePath, edgeFilePath, planarFlag, reorderFlag);
+	}
 	myGraph->delta = delta;
 	myGraph->SECTION_LENGTH = sectionLength;
+	myGraph->lazyBoundFlag  = lazyBoundFlag;
+	myGraph->labelFlag      = labelFlag;
+	initEdgeSamples(myGraph);
 	printf("The road network is initialized!!!\n");
 }
 
+/**
+ * Read the vertices and edges of a graph from the vertex file and edge file
+ * @param myGraph pointer to a graph
+ * @param nodeFilePath the file path of the vertex file
+ * @param edgeFilePath the file path of the edge file
+ * @param planarFlag whether the vertices are projected into a local plane in meters
+ * @param reorderFlag whether the vertices and edges are renumbered along a Hilbert curve
+*/
+void readTextGraph(Graph* myGraph, const string nodeFilePath, const string edgeFilePath, const bool planarFlag, const bool reorderFlag)
+{
+	myGraph->planarFlag  = planarFlag;
+	myGraph->reorderFlag = reorderFlag;
+	myGraph->mappedData = NULL;
+	myGraph->mappedSize = 0;
+	readVertexs(myGraph, nodeFilePath);
+	if (planarFlag)
+	{
+		projectVertexs(myGraph);
+	}
+	readEdges(myGraph, edgeFilePath);
+	if (reorderFlag)
+	{
+		reorderGraph(myGraph);
+	}
+	setAdjacency(myGraph);
+}
+
 /**
  * Convert integer to string
  * @param count integer to be converted
@@ -186,42 +535,115 @@ string changeIntToStr(int count)
 	return std::to_string(count);
 }
 
+/**
+ * Initialize a vertex mark with no vertex marked
+ * @param mark the mark to be initialized
+ * @param numOfVertex the number of vertices in the graph
+*/
+void initVertexMark(VertexMark* mark, const int numOfVertex)
+{
+	mark->generation = 1;
+	mark->stamps.assign(numOfVertex, 0);
+}
+
+/**
+ * Unmark all vertices by starting a new generation
+ * The stamps are only rewritten when the generation counter wraps around
+ * @param mark pointer to a vertex mark
+*/
+void clearVertexMark(VertexMark* mark)
+{
+	mark->generation++;
+	if (mark->generation == 0)
+	{
+		std::fill(mark->stamps.begin(), mark->stamps.end(), 0);
+		mark->generation = 1;
+	}
+}
+
+/**
+ * Mark a vertex
+ * @param mark pointer to a vertex mark
+ * @param vertexID the vertex to be marked
+*/
+void setVertexMark(VertexMark* mark, const int vertexID)
+{
+	mark->stamps[vertexID] = mark->generation;
+}
+
+/**
+ * Check whether a vertex is marked
+ * @param mark pointer to a vertex mark
+ * @param vertexID the vertex to be checked
+ * @return true if the vertex is marked
+*/
+bool isVertexMarked(const VertexMark* mark, const int vertexID)
+{
+	return mark->stamps[vertexID] == mark->generation;
+}
+
+/**
+ * Initialize a query context for a graph
+ * The context only has to be initialized once, setQueryEnv() resets it for each query
+ * @param myGraph pointer to a graph
+ * @param context pointer to the query context to be initialized
+*/
+void initQueryContext(const Graph* myGraph, QueryContext* context)
+{
+	context->minPos.assign(myGraph->vertexPos, 0);
+	context->maxPos.assign(myGraph->vertexPos, 0);
+	context->parentVertexID.assign(myGraph->vertexPos, -1);
+	context->distToRefer.assign(myGraph->vertexPos, 0.0);
+	context->eucLengthToFinalVertex.assign(myGraph->vertexPos, 0.0);
+	context->traversalOrderWeights.assign(myGraph->vertexPos, 0.0);
+	initVertexMark(&context->referMark, myGraph->vertexPos);
+	initVertexMark(&context->locationMark, myGraph->vertexPos);
+	initVertexMark(&context->accessMark, myGraph->vertexPos);
+	initVertexMark(&context->currMark, myGraph->vertexPos);
+	initVertexMark(&context->searchMark, myGraph->vertexPos);
+	initVertexMark(&context->lastPathMark, myGraph->vertexPos);
+	initVertexMark(&context->pathMark, myGraph->vertexPos);
+	initVertexMark(&context->labelMark, myGraph->vertexPos);
+	context->safeArea.localVertexID.assign(myGraph->vertexPos, -1);
+}
+
 /**
  * When the reference path and complete path are updated, re-set the query environment
  * @param myGraph pointer to a graph
+ * @param context pointer to the query context of this query
  * @param referencePath pointer to a reference path
  * @param completePath pointer to a complete path
  * @param inputFolder folder path when reading files
  * @param strCount indicate the number of query
 */
-void setQueryEnv(Graph* myGraph, ReferencePath* referencePath, CompletePath* completePath, string inputFolder, string strCount)
+void setQueryEnv(const Graph* myGraph, QueryContext* context, ReferencePath* referencePath, CompletePath* completePath, string inputFolder, string strCount)
 {
 	printf("Initializing a new round of query environment...\n");
 	string referFilePath = inputFolder + "/" + strCount + "referencepath.txt";
 	string comFilePath   = inputFolder + "/" + strCount + "currentpath.txt";
-	resetVertexFlag(myGraph);
-	initializeReferencePath(myGraph, referencePath, referFilePath);
+	resetVertexFlag(context);
+	initializeReferencePath(myGraph, context, referencePath, referFilePath);
 	initializeCompletePath(myGraph, completePath, comFilePath);
 	printf("A new round of query environment initialization is complete!!!\n");
 }
 
 /**
  * Set the current path based on the complete path and location pos
- * @param myGraph pointer to a graph
+ * @param context pointer to the query context, the vertices of the current path are marked in it
  * @param currentPath a pointer to a vector, representing the current path
  * @param completePath pointer to a complete path
  * @param pos indicate the location of the current path
 */
-void setCurrPath(Graph* myGraph, std::vector<Edge>* currentPath, CompletePath* completePath, const unsigned int pos)
+void setCurrPath(QueryContext* context, std::vector<Edge>* currentPath, CompletePath* completePath, const unsigned int pos)
 {
 	printf("Initializing the current path...\n");
 	for (unsigned int i = 0; i < pos; i++)
 	{
 		Edge temEdge = completePath->edges[i];
-		myGraph->vertexsVector[temEdge.firstVertexID].accessFlag = true;
-		myGraph->vertexsVector[temEdge.firstVertexID].currFlag   = true;
-		myGraph->vertexsVector[temEdge.secVertexID].accessFlag   = true;
-		myGraph->vertexsVector[temEdge.secVertexID].currFlag     = true;
+		setVertexMark(&context->accessMark, temEdge.firstVertexID);
+		setVertexMark(&context->currMark, temEdge.firstVertexID);
+		setVertexMark(&context->accessMark, temEdge.secVertexID);
+		setVertexMark(&context->currMark, temEdge.secVertexID);
 		currentPath->push_back(temEdge);
 	}
 	printf("The current path initialization is complete!!!\n");
@@ -229,26 +651,34 @@ void setCurrPath(Graph* myGraph, std::vector<Edge>* currentPath, CompletePath* c
 
 /**
  * Initialize the first Traversing path according to the current path
+ * The path tree of the context is cleared, as the paths of an earlier search are not used any more
+ * @param context pointer to the query context
  * @param path a TraversingPath that needs to be initialized
  * @param currentVertex the end of the current path
  * @param currentPath indicate the current path
 */
-void initializeFirstPath(Graph* myGraph, TraversingPath* path, int currentVertex, std::vector<Edge>& currentPath)
+void initializeFirstPath(QueryContext* context, TraversingPath* path, int currentVertex, std::vector<Edge>& currentPath)
 {
 	printf("Start initializing the first path...\n");
 	path->finalVertexID = currentVertex;
 	path->distToRefer   = 0;
 	path->minPos        = 0;
-	path->maxPos        = myGraph->vertexsVector[currentVertex].maxPos;
+	path->maxPos        = context->maxPos[currentVertex];
+	path->eucDelta      = 0;
+	path->eucDeltaOfTrue = 0;
+	path->exactBoundFlag = true;
+	path->lastNode      = -1;
+	path->numOfEdge     = currentPath.size();
+	context->pathTree.clear();
 	for (unsigned int i = 0; i < currentPath.size(); i++)
 	{
-		const Vertex firstVertex = myGraph->vertexsVector[currentPath[i].firstVertexID];
-		const Vertex secVertex   = myGraph->vertexsVector[currentPath[i].secVertexID];
-		path->edges.push_back(currentPath[i].edgeID);
-		path->distToRefer = std::max(path->distToRefer, firstVertex.distToRefer);
-		path->distToRefer = std::max(path->distToRefer, secVertex.distToRefer);
-		path->minPos      = std::max(path->minPos, firstVertex.minPos);
-		path->minPos      = std::max(path->minPos, secVertex.minPos);
+		const int firstVertexID = currentPath[i].firstVertexID;
+		const int secVertexID   = currentPath[i].secVertexID;
+		path->lastNode    = addPathNode(context, path->lastNode, currentPath[i].edgeID);
+		path->distToRefer = std::max(path->distToRefer, context->distToRefer[firstVertexID]);
+		path->distToRefer = std::max(path->distToRefer, context->distToRefer[secVertexID]);
+		path->minPos      = std::max(path->minPos, context->minPos[firstVertexID]);
+		path->minPos      = std::max(path->minPos, context->minPos[secVertexID]);
 	}
 	printf("The first path is initialized!!!\n");
 }
@@ -262,13 +692,30 @@ void initializeFirstPath(Graph* myGraph, TraversingPath* path, int currentVertex
 */
 double realDistance(const double lonDiff, const double latDiff, const double cosLongitude)
 {
-	const  double CONST_DISTANCE_ONE_DEGREE = 111111;
-	double lonDistance = lonDiff * CONST_DISTANCE_ONE_DEGREE * cos(cosLongitude);
-	double latDistance = latDiff * CONST_DISTANCE_ONE_DEGREE;
+	double lonDistance = lonDiff * DISTANCE_ONE_DEGREE * cos(cosLongitude);
+	double latDistance = latDiff * DISTANCE_ONE_DEGREE;
 	double dist = sqrt(lonDistance * lonDistance + latDistance * latDistance);
 	return dist;
 }
 
+/**
+ * Calculate the real distance of a coordinate difference in the graph
+ * The coordinates are already in meters if the graph is projected, so no trig is needed then
+ * @param myGraph pointer to a graph
+ * @param xDiff difference in x
+ * @param yDiff difference in y
+ * @param y the y used as cosLongitude by realDistance() if the graph is not projected
+ * @return the real distance of the coordinate difference
+*/
+double graphRealDistance(const Graph* myGraph, const double xDiff, const double yDiff, const double y)
+{
+	if (myGraph->planarFlag)
+	{
+		return sqrt(xDiff * xDiff + yDiff * yDiff);
+	}
+	return realDistance(xDiff, yDiff, y);
+}
+
 /**
  * Set the length of the reference path
  * @param temPath pointer to a reference path
@@ -283,35 +730,85 @@ void setReferPathLength(ReferencePath* temPath)
 	}
 }
 
+/**
+ * Build the uniform grid over the edges of the reference path
+ * The bounding box of each edge is expanded by a little more than delta, so every vertex within
+ * delta of an edge falls in one of its cells, the cells are about delta wide
+ * @param myGraph pointer to a graph
+ * @param temPath pointer to a reference path
+*/
+void setSegmentGrid(const Graph* myGraph, ReferencePath* temPath)
+{
+	const int numOfEdge = temPath->edges.size();
+	double scale = 0.0;
+	for (int i = 0; i < numOfEdge; i++)
+	{
+		const int firstVertexID = temPath->edges[i].firstVertexID;
+		const int secVertexID   = temPath->edges[i].secVertexID;
+		scale = (std::max)(scale, (std::max)(fabs(myGraph->xOfVertex[firstVertexID]), fabs(myGraph->yOfVertex[firstVertexID])));
+		scale = (std::max)(scale, (std::max)(fabs(myGraph->xOfVertex[secVertexID]), fabs(myGraph->yOfVertex[secVertexID])));
+	}
+	const double pad = gridPad(myGraph->delta, 2 * scale);
+	std::vector<Point> boxMin(numOfEdge);
+	std::vector<Point> boxMax(numOfEdge);
+	for (int i = 0; i < numOfEdge; i++)
+	{
+		const int firstVertexID = temPath->edges[i].firstVertexID;
+		const int secVertexID   = temPath->edges[i].secVertexID;
+		boxMin[i].x = (std::min)(myGraph->xOfVertex[firstVertexID], myGraph->xOfVertex[secVertexID]) - pad;
+		boxMin[i].y = (std::min)(myGraph->yOfVertex[firstVertexID], myGraph->yOfVertex[secVertexID]) - pad;
+		boxMax[i].x = (std::max)(myGraph->xOfVertex[firstVertexID], myGraph->xOfVertex[secVertexID]) + pad;
+		boxMax[i].y = (std::max)(myGraph->yOfVertex[firstVertexID], myGraph->yOfVertex[secVertexID]) + pad;
+	}
+	fillGrid(temPath->segmentGrid, boxMin, boxMax, myGraph->delta);
+}
+
+/**
+ * Build the uniform grid over the trajectory points of the reference path
+ * The cells are about delta wide
+ * @param myGraph pointer to a graph
+ * @param temPath pointer to a reference path
+*/
+void setReferPointGrid(const Graph* myGraph, ReferencePath* temPath)
+{
+	std::vector<Point> points(temPath->pointOfRefer, temPath->pointOfRefer + temPath->numOfReferPoint);
+	fillGrid(temPath->pointGrid, points, points, myGraph->delta);
+}
+
 /**
  * Filter out vertices that are not in the safe area
+ * Vertices outside the grid of the reference path are skipped outright,
+ * the others are only checked against the edges listed in their grid cell
  * @param myGraph pointer to a graph
+ * @param context pointer to the query context
  * @param temPath pointer to a reference path
 */
-void filterVertexIsSafeArea(Graph* myGraph, ReferencePath* temPath)
+void filterVertexIsSafeArea(const Graph* myGraph, QueryContext* context, ReferencePath* temPath)
 {
 	printf("Start filtering the vertices in the safe area...\n");
+	const UniformGrid& grid = temPath->segmentGrid;
 	int count = 0;
 	for (int i = 0; i < (myGraph->vertexPos); i++)
 	{
-		if (myGraph->vertexsVector[i].referFlag == true)
+		if (isVertexMarked(&context->referMark, i))
 		{
-			myGraph->vertexsVector[i].locationFlag = true;
+			setVertexMark(&context->locationMark, i);
 			count++;
 			continue;
 		}
-		for (unsigned int j = 0; j < temPath->edges.size(); j++)
+		double x = myGraph->xOfVertex[i];
+		double y = myGraph->yOfVertex[i];
+		if ((x < grid.minX) || (x > grid.maxX) || (y < grid.minY) || (y > grid.maxY))
+		{
+			continue;
+		}
+		int cell = gridCellPos(y, grid.minY, grid.cellSize, grid.numOfRow) * grid.numOfCol + gridCellPos(x, grid.minX, grid.cellSize, grid.numOfCol);
+		for (int j = grid.cellStart[cell]; j < grid.cellStart[cell + 1]; j++)
 		{
-			double x = myGraph->vertexsVector[i].longitude;
-			double y = myGraph->vertexsVector[i].latitude;
-			double x1 = myGraph->vertexsVector[temPath->edges[j].firstVertexID].longitude;
-			double y1 = myGraph->vertexsVector[temPath->edges[j].firstVertexID].latitude;
-			double x2 = myGraph->vertexsVector[temPath->edges[j].secVertexID].longitude;
-			double y2 = myGraph->vertexsVector[temPath->edges[j].secVertexID].latitude;
-			double dist = pointToSegDist(x, y, x1, y1, x2, y2);
+			double dist = pointToReferEdgeDist(myGraph, temPath, x, y, grid.cellItems[j]);
 			if (dist <= (myGraph->delta))
 			{
-				myGraph->vertexsVector[i].locationFlag = true;
+				setVertexMark(&context->locationMark, i);
 				count++;
 				break;
 			}
@@ -320,6 +817,80 @@ void filterVertexIsSafeArea(Graph* myGraph, ReferencePath* temPath)
 	printf("Finished filtering the vertices in the safe area!!!\n");
 }
 
+/**
+ * Extract the vertices in the safe area and the edges between them into the safe area subgraph of the query context
+ * @param myGraph pointer to a graph
+ * @param context pointer to the query context, the vertices in the safe area have to be marked in it
+*/
+void setSafeArea(const Graph* myGraph, QueryContext* context)
+{
+	SafeArea* area = &context->safeArea;
+	area->globalVertexID.clear();
+	area->xOfVertex.clear();
+	area->yOfVertex.clear();
+	area->adjacency.clear();
+	area->adjStart.assign(1, 0);
+	for (int i = 0; i < myGraph->vertexPos; i++)
+	{
+		if (isVertexMarked(&context->locationMark, i))
+		{
+			area->localVertexID[i] = area->globalVertexID.size();
+			area->globalVertexID.push_back(i);
+			area->xOfVertex.push_back(myGraph->xOfVertex[i]);
+			area->yOfVertex.push_back(myGraph->yOfVertex[i]);
+		}
+		else
+		{
+			area->localVertexID[i] = -1;
+		}
+	}
+	for (unsigned int v = 0; v < area->globalVertexID.size(); v++)
+	{
+		int vertexID = area->globalVertexID[v];
+		for (int k = myGraph->adjStart[vertexID]; k < myGraph->adjStart[vertexID + 1]; k++)
+		{
+			if (isVertexMarked(&context->locationMark, myGraph->adjacency[2 * k]))
+			{
+				area->adjacency.push_back(myGraph->adjacency[2 * k]);
+				area->adjacency.push_back(myGraph->adjacency[2 * k + 1]);
+			}
+		}
+		area->adjStart.push_back(area->adjacency.size() / 2);
+	}
+	printf("The safe area has %d vertex and %d neighbor!!!\n", (int)area->globalVertexID.size(), area->adjStart.back());
+}
+
+/**
+ * Add a vertex outside the safe area to the safe area subgraph, so that a search can start from it
+ * The vertex only gets its neighbors in the safe area, it is neither marked in locationMark nor a neighbor of any other vertex
+ * @param myGraph pointer to a graph
+ * @param context pointer to the query context
+ * @param vertexID the vertex to be added
+ * @return ID of the vertex in the safe area subgraph
+*/
+int addSafeAreaVertex(const Graph* myGraph, QueryContext* context, const int vertexID)
+{
+	SafeArea* area = &context->safeArea;
+	if (area->localVertexID[vertexID] != -1)
+	{
+		return area->localVertexID[vertexID];
+	}
+	area->localVertexID[vertexID] = area->globalVertexID.size();
+	area->globalVertexID.push_back(vertexID);
+	area->xOfVertex.push_back(myGraph->xOfVertex[vertexID]);
+	area->yOfVertex.push_back(myGraph->yOfVertex[vertexID]);
+	for (int k = myGraph->adjStart[vertexID]; k < myGraph->adjStart[vertexID + 1]; k++)
+	{
+		if (isVertexMarked(&context->locationMark, myGraph->adjacency[2 * k]))
+		{
+			area->adjacency.push_back(myGraph->adjacency[2 * k]);
+			area->adjacency.push_back(myGraph->adjacency[2 * k + 1]);
+		}
+	}
+	area->adjStart.push_back(area->adjacency.size() / 2);
+	return area->localVertexID[vertexID];
+}
+
 /**
  * Calculate the shortest distance from a point to a line segment
  * @param x vertex x
@@ -350,44 +921,22 @@ double pointToSegDist(const double x, const double y, const double x1, const dou
 
 /**
  * Set minPos and maxPos for each vertex int the safe area
+ * The trajectory points within delta of the vertex are looked up in the point grid of the reference path
  * @param myGraph pointer to a graph
+ * @param context pointer to the query context, the safe area subgraph has to be set
  * @param temReferPath pointer to a reference path
 */
-void setMinPosAndMaxPos(Graph* myGraph, ReferencePath* temReferPath)
+void setMinPosAndMaxPos(const Graph* myGraph, QueryContext* context, ReferencePath* temReferPath)
 {
 	printf("Start to set the minPos and maxPos of each vertex...\n");
-	for (unsigned int i = 0; i < (myGraph->vertexPos); i++)
+	const SafeArea* area = &context->safeArea;
+	std::fill(context->minPos.begin(), context->minPos.end(), 0);
+	std::fill(context->maxPos.begin(), context->maxPos.end(), 0);
+	for (unsigned int v = 0; v < area->globalVertexID.size(); v++)
 	{
-		myGraph->vertexsVector[i].minPos = 0;
-		myGraph->vertexsVector[i].maxPos = 0;
-		if (myGraph->vertexsVector[i].locationFlag == true)
-		{
-			double x1 = myGraph->vertexsVector[i].longitude;
-			double y1 = myGraph->vertexsVector[i].latitude;
-			for (unsigned int j = 0; j < temReferPath->numOfReferPoint; j++)
-			{
-				double x2 = temReferPath->pointOfRefer[j].x;
-				double y2 = temReferPath->pointOfRefer[j].y;
-				double dist = euc(x1, y1, x2, y2);
-				if (dist <= (myGraph->delta))
-				{
-					myGraph->vertexsVector[i].minPos = j;
-					break;
-				}
-			}
-			int numOfReferPoint = temReferPath->numOfReferPoint - 1;
-			for (int j = numOfReferPoint; j >= 0; j--)
-			{
-				double x2 = temReferPath->pointOfRefer[j].x;
-				double y2 = temReferPath->pointOfRefer[j].y;
-				double dist = euc(x1, y1, x2, y2);
-				if (dist <= (myGraph->delta))
-				{
-					myGraph->vertexsVector[i].maxPos = j;
-					break;
-				}
-			}
-		}
+		int i = area->globalVertexID[v];
+		findReferPointWithin(myGraph, temReferPath, area->xOfVertex[v], area->yOfVertex[v], 0, temReferPath->numOfReferPoint - 1,
+			&(context->minPos[i]), &(context->maxPos[i]));
 	}
 	printf("The minPos and maxPos of each vertex are set...\n");
 }
@@ -409,71 +958,92 @@ double euc(const double px, const double py, const double qx, const double qy)
 
 /**
  * Set the DFD flag of the reference path
+ * The flag is true if every trajectory point between minPos and maxPos of the final vertex is within delta of it
  * @param myGraph pointer to a graph
+ * @param context pointer to the query context
  * @param temPath pointer to a reference path
 */
-void setReferDFDFlag(Graph* myGraph, ReferencePath* temPath)
+void setReferDFDFlag(const Graph* myGraph, QueryContext* context, ReferencePath* temPath)
 {
-	Vertex finalVertex = myGraph->vertexsVector[temPath->finalVertex];
-	if (finalVertex.locationFlag == false)
+	const int finalVertex = temPath->finalVertex;
+	if (!isVertexMarked(&context->locationMark, finalVertex))
 	{
 		temPath->referDFDFlag = false;
 	}
+	else if (context->maxPos[finalVertex] < context->minPos[finalVertex])
+	{
+		temPath->referDFDFlag = true;
+	}
 	else
 	{
-		int flag = 0;
-		for (int j = finalVertex.minPos; j <= finalVertex.maxPos; j++)
-		{
-			double x1 = finalVertex.longitude;
-			double y1 = finalVertex.latitude;
-			double x2 = temPath->pointOfRefer[j].x;
-			double y2 = temPath->pointOfRefer[j].y;
-			if (euc(x1, y1, x2, y2) > (myGraph->delta))
-			{
-				flag = 1;
-				break;
-			}
-		}
-		if (flag == 1)
-		{
-			temPath->referDFDFlag = false;
-		}
-		else
-		{
-			temPath->referDFDFlag = true;
-		}
+		int minPos, maxPos;
+		int count = findReferPointWithin(myGraph, temPath, myGraph->xOfVertex[finalVertex], myGraph->yOfVertex[finalVertex],
+			context->minPos[finalVertex], context->maxPos[finalVertex], &minPos, &maxPos);
+		temPath->referDFDFlag = (count == context->maxPos[finalVertex] - context->minPos[finalVertex] + 1);
 	}
 }
 
 /**
  * Set the distance from the vertex on the road network to the reference path
  * The distance is defined as the shortest distance from the vertex to each edge of the reference path
+ * The grid cells are visited in rings around the cell of the vertex, until the cells left
+ * are farther from the vertex than the shortest distance found so far
  * @param myGraph pointer to a graph
+ * @param context pointer to the query context
  * @param temPath pointer to a reference path
 */
-void setDistToRefer(Graph* myGraph, ReferencePath* temPath)
+void setDistToRefer(const Graph* myGraph, QueryContext* context, ReferencePath* temPath)
 {
 	printf("Start calculating the shortest distance from each vertex to the reference path...\n");
+	const UniformGrid& grid = temPath->segmentGrid;
 	for (unsigned int i = 0; i < myGraph->vertexPos; i++)
 	{
 		double temDist = std::numeric_limits<double>::max();
-		if (myGraph->vertexsVector[i].referFlag == true)
+		if (isVertexMarked(&context->referMark, i))
 		{
-			myGraph->vertexsVector[i].distToRefer = 0;
+			context->distToRefer[i] = 0;
 			continue;
 		}
-		for (unsigned int j = 0; j < temPath->edges.size(); j++)
+		double x  = myGraph->xOfVertex[i];
+		double y  = myGraph->yOfVertex[i];
+		int    cx = gridCellPos(x, grid.minX, grid.cellSize, grid.numOfCol);
+		int    cy = gridCellPos(y, grid.minY, grid.cellSize, grid.numOfRow);
+		for (int r = 0; ; r++)
 		{
-			double x  = myGraph->vertexsVector[i].longitude;
-			double y  = myGraph->vertexsVector[i].latitude;
-			double x1 = myGraph->vertexsVector[temPath->edges[j].firstVertexID].longitude;
-			double y1 = myGraph->vertexsVector[temPath->edges[j].firstVertexID].latitude;
-			double x2 = myGraph->vertexsVector[temPath->edges[j].secVertexID].longitude;
-			double y2 = myGraph->vertexsVector[temPath->edges[j].secVertexID].latitude;
-			double dist = pointToSegDist(x, y, x1, y1, x2, y2);
-			temDist = dist < temDist ? dist : temDist;
+			int firstCol = (std::max)(cx - r, 0);
+			int lastCol  = (std::min)(cx + r, grid.numOfCol - 1);
+			int firstRow = (std::max)(cy - r, 0);
+			int lastRow  = (std::min)(cy + r, grid.numOfRow - 1);
+			for (int row = firstRow; row <= lastRow; row++)
+			{
+				// inner rows only have the two cells on the ring
+				int step = ((row == cy - r) || (row == cy + r)) ? 1 : 2 * r;
+				for (int col = cx - r; col <= cx + r; col += (step > 0 ? step : 1))
+				{
+					if ((col < 0) || (col >= grid.numOfCol))
+					{
+						continue;
+					}
+					int cell = row * grid.numOfCol + col;
+					for (int j = grid.cellStart[cell]; j < grid.cellStart[cell + 1]; j++)
+					{
+						double dist = pointToReferEdgeDist(myGraph, temPath, x, y, grid.cellItems[j]);
+						temDist = dist < temDist ? dist : temDist;
+					}
+				}
+			}
+			// the cells outside the block visited so far form at most four rectangles
+			double restDist = DBL_MAX;
+			restDist = (std::min)(restDist, pointToCellsDist(grid, x, y, 0, firstCol - 1, 0, grid.numOfRow - 1));
+			restDist = (std::min)(restDist, pointToCellsDist(grid, x, y, lastCol + 1, grid.numOfCol - 1, 0, grid.numOfRow - 1));
+			restDist = (std::min)(restDist, pointToCellsDist(grid, x, y, firstCol, lastCol, 0, firstRow - 1));
+			restDist = (std::min)(restDist, pointToCellsDist(grid, x, y, firstCol, lastCol, lastRow + 1, grid.numOfRow - 1));
+			if ((restDist == DBL_MAX) || (temDist <= restDist))
+			{
+				break;
+			}
 		}
-		myGraph->vertexsVector[i].distToRefer = temDist;
+		context->distToRefer[i] = temDist;
 	}
 	printf("The shortest distance from each vertex to the reference path is calculated!!!\n");
 }
@@ -481,33 +1051,35 @@ void setDistToRefer(Graph* myGraph, ReferencePath* temPath)
 /**
  * Set the traversialOrderWeights of each vertex on the road network
  * @param myGraph pointer to a graph
+ * @param context pointer to the query context
  * @param temPath pointer to a reference path
 */
-void setTraversalOrderWeights(Graph* myGraph, ReferencePath* temPath)
+void setTraversalOrderWeights(const Graph* myGraph, QueryContext* context, ReferencePath* temPath)
 {
-	const double x1 = myGraph->vertexsVector[temPath->finalVertex].longitude;
-	const double y1 = myGraph->vertexsVector[temPath->finalVertex].latitude;
+	const int     numOfVertex = myGraph->vertexPos;
+	const double  x1          = myGraph->xOfVertex[temPath->finalVertex];
+	const double  y1          = myGraph->yOfVertex[temPath->finalVertex];
+	const double* xs          = myGraph->xOfVertex;
+	const double* ys          = myGraph->yOfVertex;
+	double*       eucLengths  = &context->eucLengthToFinalVertex[0];
+	double*       distToRefer = &context->distToRefer[0];
+	double*       weights     = &context->traversalOrderWeights[0];
+
+	// the sweeps run over every vertex without branches so that they can be vectorized,
+	// the values of the vertices outside the safe area are never read
+	for (int i = 0; i < numOfVertex; i++)
+	{
+		eucLengths[i] = sqrt((x1 - xs[i]) * (x1 - xs[i]) + (y1 - ys[i]) * (y1 - ys[i]));
+	}
 	double maxEuc = 0.0;
-	for (unsigned int i = 0; i < myGraph->vertexPos; i++)
+	for (unsigned int v = 0; v < context->safeArea.globalVertexID.size(); v++)
 	{
-		if (myGraph->vertexsVector[i].locationFlag == true)
-		{
-			const double x2 = myGraph->vertexsVector[i].longitude;
-			const double y2 = myGraph->vertexsVector[i].latitude;
-			double eucLength = euc(x1, y1, x2, y2);
-			myGraph->vertexsVector[i].eucLengthToFinalVertex = eucLength;
-			maxEuc = (std::max)(maxEuc, eucLength);
-		}
+		maxEuc = (std::max)(maxEuc, eucLengths[context->safeArea.globalVertexID[v]]);
 	}
-	for (unsigned int i = 0; i < myGraph->vertexPos; i++)
+	const double eucScale = maxEuc / (myGraph->delta);
+	for (int i = 0; i < numOfVertex; i++)
 	{
-		if (myGraph->vertexsVector[i].locationFlag == true)
-		{
-			double firstHalf = (myGraph->vertexsVector[i].distToRefer);
-			double secHalf   = (myGraph->vertexsVector[i].eucLengthToFinalVertex) / (maxEuc / (myGraph->delta));
-			double temWeights = (0.5) * firstHalf+ (0.5) * secHalf;
-			myGraph->vertexsVector[i].traversalOrderWeights = temWeights;
-		}
+		weights[i] = (0.5) * distToRefer[i] + (0.5) * (eucLengths[i] / eucScale);
 	}
 }
 
@@ -516,16 +1088,16 @@ void setTraversalOrderWeights(Graph* myGraph, ReferencePath* temPath)
  * @param myGraph pointer to a graph
  * @param temEdge pointer to a edge
 */
-void setEdgeLength(Graph* myGraph, Edge* temEdge)
+void setEdgeLength(const Graph* myGraph, Edge* temEdge)
 {
-	double px = myGraph->vertexsVector[temEdge->firstVertexID].longitude;
-	double py = myGraph->vertexsVector[temEdge->firstVertexID].latitude;
-	double qx = myGraph->vertexsVector[temEdge->secVertexID].longitude;
-	double qy = myGraph->vertexsVector[temEdge->secVertexID].latitude;
+	double px = myGraph->xOfVertex[temEdge->firstVertexID];
+	double py = myGraph->yOfVertex[temEdge->firstVertexID];
+	double qx = myGraph->xOfVertex[temEdge->secVertexID];
+	double qy = myGraph->yOfVertex[temEdge->secVertexID];
 	double x = px - qx;
 	double y = py - qy;
 	temEdge->length = sqrt(x * x + y * y);
-	temEdge->realLength = realDistance(x, y, py);
+	temEdge->realLength = myGraph->planarFlag ? temEdge->length : realDistance(x, y, py);
 	// printf("%lf %lf %lf\n", x, y, py);
 }
 
@@ -603,68 +1175,352 @@ void writeContinuousRecordToFile(Record record[], const unsigned int recordPos,
 	fclose(fp);
 }
 
+/**
+ * Hash an ordered pair of vertices into the edge table
+ * @param firstVertexID the first vertex of the pair
+ * @param secVertexID the second vertex of the pair
+ * @return the hash value, to be masked by edgeTableMask
+*/
+unsigned int edgeTableHash(const int firstVertexID, const int secVertexID)
+{
+	unsigned long long key = ((unsigned long long)(unsigned int)firstVertexID << 32) | (unsigned int)secVertexID;
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	return (unsigned int)key;
+}
+
+/**
+ * Build the edge table of a graph from its adjacency
+ * Each ordered pair of adjacent vertices is stored once, with the first of its edges in the adjacency,
+ * the table is at least twice as large as the adjacency so that the probes stay short
+ * @param myGraph pointer to a graph
+*/
+void setEdgeTable(Graph* myGraph)
+{
+	const int numOfAdjacency = myGraph->adjStart[myGraph->vertexPos];
+	unsigned int tableSize = 16;
+	while (tableSize < 2 * (unsigned int)numOfAdjacency)
+	{
+		tableSize *= 2;
+	}
+	myGraph->edgeTableMask = tableSize - 1;
+	myGraph->edgeTable     = new int[tableSize];
+	std::fill(myGraph->edgeTable, myGraph->edgeTable + tableSize, -1);
+	for (int v = 0; v < myGraph->vertexPos; v++)
+	{
+		for (int k = myGraph->adjStart[v]; k < myGraph->adjStart[v + 1]; k++)
+		{
+			if (findEdgeID(myGraph, v, myGraph->adjacency[2 * k], NULL) != -1)
+			{
+				continue;
+			}
+			unsigned int slot = edgeTableHash(v, myGraph->adjacency[2 * k]) & myGraph->edgeTableMask;
+			while (myGraph->edgeTable[slot] != -1)
+			{
+				slot = (slot + 1) & myGraph->edgeTableMask;
+			}
+			myGraph->edgeTable[slot] = k;
+		}
+	}
+}
+
+/**
+ * Find the edge between two vertices on the road network in the edge table
+ * @param myGraph pointer to a graph
+ * @param firstVertexID the vertex the edge is traversed from
+ * @param secVertexID the vertex the edge is traversed to
+ * @param forwardFlag set to true if the edge is traversed from its firstVertexID to its secVertexID, ignored if NULL
+ * @return the ID of the edge, -1 if the two vertices are not adjacent
+*/
+int findEdgeID(const Graph* myGraph, const int firstVertexID, const int secVertexID, bool* forwardFlag)
+{
+	unsigned int slot = edgeTableHash(firstVertexID, secVertexID) & myGraph->edgeTableMask;
+	while (myGraph->edgeTable[slot] != -1)
+	{
+		int k = myGraph->edgeTable[slot];
+		if ((myGraph->adjacency[2 * k] == secVertexID) && (k >= myGraph->adjStart[firstVertexID]) && (k < myGraph->adjStart[firstVertexID + 1]))
+		{
+			int edgeID = myGraph->adjacency[2 * k + 1];
+			if (forwardFlag != NULL)
+			{
+				(*forwardFlag) = (myGraph->edgesVector[edgeID].firstVertexID == firstVertexID);
+			}
+			return edgeID;
+		}
+		slot = (slot + 1) & myGraph->edgeTableMask;
+	}
+	return -1;
+}
+
 /**
  * Find the edge corresponding to two vertices on the road network
  * @param myGraph pointer to a graph
- * @param firstVertex the first vertex to look for
- * @param secVertex the second vertex to look for
- * @return edge found
+ * @param firstVertexID the first vertex to look for
+ * @param secVertexID the second vertex to look for
+ * @return edge found, the two vertices have to be adjacent
+*/
+Edge findEdge(const Graph* myGraph, const int firstVertexID, const int secVertexID)
+{
+	int edgeID = findEdgeID(myGraph, firstVertexID, secVertexID, NULL);
+	assert(edgeID != -1);
+	return myGraph->edgesVector[edgeID];
+}
+
+/**
+ * Add a node to the path tree of a query context
+ * @param context pointer to the query context
+ * @param parentNode the node of the previous edge, -1 if the edge is the first one of a path
+ * @param edgeID the edge of the node
+ * @return position of the new node in the path tree
+*/
+int addPathNode(QueryContext* context, const int parentNode, const int edgeID)
+{
+	PathNode node;
+	node.parentNode = parentNode;
+	node.edgeID     = edgeID;
+	context->pathTree.push_back(node);
+	return context->pathTree.size() - 1;
+}
+
+/**
+ * Materialize the edge IDs of a traversing path from the path tree, from its first edge to its last edge
+ * @param context pointer to the query context that holds the path tree
+ * @param path pointer to a traversing path
+ * @param edgeIDs the IDs of the edges of the path, this variable is the return value
+*/
+void getPathEdgeIDs(const QueryContext* context, const TraversingPath* path, std::vector<int>& edgeIDs)
+{
+	edgeIDs.resize(path->numOfEdge);
+	int node = path->lastNode;
+	for (int i = path->numOfEdge - 1; i >= 0; i--)
+	{
+		edgeIDs[i] = context->pathTree[node].edgeID;
+		node = context->pathTree[node].parentNode;
+	}
+}
+
+/**
+ * Materialize the edges of a traversing path from the path tree, from its first edge to its last edge
+ * @param myGraph pointer to a graph
+ * @param context pointer to the query context that holds the path tree
+ * @param path pointer to a traversing path
+ * @param edges the edges of the path, this variable is the return value
+*/
+void getPathEdges(const Graph* myGraph, const QueryContext* context, const TraversingPath* path, std::vector<Edge>& edges)
+{
+	edges.resize(path->numOfEdge);
+	int node = path->lastNode;
+	for (int i = path->numOfEdge - 1; i >= 0; i--)
+	{
+		edges[i] = myGraph->edgesVector[context->pathTree[node].edgeID];
+		node = context->pathTree[node].parentNode;
+	}
+}
+
+/**
+ * Release the paths and the frontier of the last search of a query context at once
+ * @param context pointer to the query context
 */
-Edge findEdge(Graph* myGraph, Vertex firstVertex, Vertex secVertex)
+void clearPathHeap(QueryContext* context)
 {
-	for (unsigned int i = 0; i < firstVertex.adjVertexID.size(); i++)
+	context->pathArena.clear();
+	context->pathHeap.clear();
+}
+
+/**
+ * Push a traversing path into the frontier, keyed by its eucDelta
+ * The path is copied into the path arena, the heap only moves small entries
+ * @param context pointer to the query context
+ * @param path the path to be pushed
+*/
+void pushPath(QueryContext* context, const TraversingPath& path)
+{
+	std::vector<PathHeapEntry>& heap = context->pathHeap;
+	PathHeapEntry entry;
+	entry.key       = path.eucDelta;
+	entry.pathIndex = context->pathArena.size();
+	context->pathArena.push_back(path);
+
+	int pos = heap.size();
+	heap.push_back(entry);
+	while (pos > 0)
 	{
-		if (firstVertex.adjVertexID[i] == secVertex.vertexID)
+		int parent = (pos - 1) / PATH_HEAP_ARITY;
+		if (!pathHeapLess(entry, heap[parent]))
 		{
-			return myGraph->edgesVector[firstVertex.adjEdgeID[i]];
+			break;
 		}
+		heap[pos] = heap[parent];
+		pos = parent;
 	}
+	heap[pos] = entry;
+}
+
+/**
+ * Pop the traversing path with the smallest eucDelta from the frontier
+ * @param context pointer to the query context, the frontier must not be empty
+ * @return pointer to the path in the path arena, it stays valid until the arena is cleared
+*/
+TraversingPath* popPath(QueryContext* context)
+{
+	std::vector<PathHeapEntry>& heap = context->pathHeap;
+	int pathIndex = heap[0].pathIndex;
+	PathHeapEntry entry = heap.back();
+	heap.pop_back();
+	const int size = heap.size();
+	if (size > 0)
+	{
+		int pos = 0;
+		while (true)
+		{
+			int firstChild = pos * PATH_HEAP_ARITY + 1;
+			if (firstChild >= size)
+			{
+				break;
+			}
+			int lastChild = std::min(firstChild + PATH_HEAP_ARITY, size);
+			int minChild  = firstChild;
+			for (int child = firstChild + 1; child < lastChild; child++)
+			{
+				if (pathHeapLess(heap[child], heap[minChild]))
+				{
+					minChild = child;
+				}
+			}
+			if (!pathHeapLess(heap[minChild], entry))
+			{
+				break;
+			}
+			heap[pos] = heap[minChild];
+			pos = minChild;
+		}
+		heap[pos] = entry;
+	}
+	return &(context->pathArena[pathIndex]);
+}
+
+/**
+ * Clear the path labels of the last search of a query context
+ * @param context pointer to the query context
+*/
+void clearPathLabels(QueryContext* context)
+{
+	context->pathLabels.resize(context->safeArea.globalVertexID.size());
+	for (unsigned int i = 0; i < context->pathLabels.size(); i++)
+	{
+		context->pathLabels[i].clear();
+	}
+}
+
+/**
+ * Add the label of a path to the labels of its final vertex, unless it is dominated by one of them
+ * The labels that the new one dominates are dropped, so each vertex keeps a Pareto set
+ * A path only dominates another one if it visits no vertex the other one does not visit, as the searched paths are simple
+ * and every continuation of the other path has to stay open to it
+ * @param myGraph pointer to a graph
+ * @param context pointer to the query context, the final vertex of the path has to be in the safe area subgraph
+ * @param path pointer to a traversing path with its dfd row and eucDeltaOfTrue set
+ * @return false if the path is dominated and does not have to be searched any further
+*/
+bool addPathLabel(const Graph* myGraph, QueryContext* context, const TraversingPath* path)
+{
+	PathLabel label;
+	label.lastNode    = path->lastNode;
+	label.minPos      = path->minPos;
+	label.distToRefer = path->distToRefer;
+	label.lowerBound  = path->eucDeltaOfTrue;
+	label.dfdRow      = path->dfdRow;
+	int localVertexID = context->safeArea.localVertexID[path->finalVertexID];
+	if (localVertexID >= (int)context->pathLabels.size())
+	{
+		context->pathLabels.resize(localVertexID + 1);
+	}
+	std::vector<PathLabel>& labels = context->pathLabels[localVertexID];
+	markPathNodeVertices(myGraph, context, &context->labelMark, label.lastNode);
+	for (unsigned int i = 0; i < labels.size(); i++)
+	{
+		if (pathLabelDominates(labels[i], label) && pathNodeVerticesMarked(myGraph, context, &context->labelMark, labels[i].lastNode))
+		{
+			return false;
+		}
+	}
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < labels.size(); i++)
+	{
+		bool dominatedFlag = pathLabelDominates(label, labels[i]);
+		if (dominatedFlag)
+		{
+			markPathNodeVertices(myGraph, context, &context->labelMark, labels[i].lastNode);
+			dominatedFlag = pathNodeVerticesMarked(myGraph, context, &context->labelMark, label.lastNode);
+		}
+		if (!dominatedFlag)
+		{
+			labels[count++] = labels[i];
+		}
+	}
+	labels.resize(count);
+	labels.push_back(label);
+	return true;
 }
 
 /**
  * Processing function when traversing to a new path
+ * In lazy bound mode the dfd row is only extended here if the new vertex is on the reference path,
+ * otherwise it is left to settleLowerBound() and exactBoundFlag is cleared
  * @param myGraph pointer to a graph
+ * @param context pointer to the query context
  * @param oldPath old path used for copying
  * @param newPath new path to be processed
  * @param newVertexID new vertex extended to
+ * @param referencePath pointer to a reference path, used to extend the dfd row of the new path
 */
-void handleNewPath(Graph* myGraph, TraversingPath* oldPath, TraversingPath* newPath, const int newVertexID)
+void handleNewPath(const Graph* myGraph, QueryContext* context, TraversingPath* oldPath, TraversingPath* newPath, const int newVertexID, ReferencePath* referencePath)
 {
 	printf("Start processing new Traversingpath...\n");
 	(*newPath) = (*oldPath);
-	const Vertex finalVertex = myGraph->vertexsVector[oldPath->finalVertexID];
-	const Vertex newVertex   = myGraph->vertexsVector[newVertexID];
-	newPath->edges.push_back(findEdge(myGraph, newVertex, finalVertex).edgeID);
+	newPath->lastNode = addPathNode(context, oldPath->lastNode, findEdgeID(myGraph, newVertexID, oldPath->finalVertexID, NULL));
+	newPath->numOfEdge++;
 	newPath->finalVertexID = newVertexID;
-	newPath->distToRefer   = std::max(newPath->distToRefer, newVertex.distToRefer);
-	if (newPath->minPos < newVertex.minPos)
+	newPath->distToRefer   = std::max(newPath->distToRefer, context->distToRefer[newVertexID]);
+	if (newPath->minPos < context->minPos[newVertexID])
+	{
+		newPath->minPos = context->minPos[newVertexID];
+	}
+	newPath->maxPos = context->maxPos[newVertexID];
+	if (myGraph->lazyBoundFlag && !isVertexMarked(&context->referMark, newVertexID))
+	{
+		newPath->exactBoundFlag = false;
+	}
+	else
 	{
-		newPath->minPos = newVertex.minPos;
+		extendPathDFDRow(myGraph, context, newPath, referencePath, oldPath->finalVertexID);
 	}
-	newPath->maxPos = newVertex.maxPos;
 	printf("Processing the new Traversingpath is complete!!!\n");
 }
 
 /**
- * Check whether a path passes through a vertex
- * If it goes through, return false, otherwise return true
+ * Mark the vertices of a path in pathMark, so that checkIfAccess() answers in constant time
+ * The path is walked once when it is expanded instead of once for every neighbor of its final vertex
  * @param myGraph pointer to a graph
+ * @param context pointer to the query context that holds the path tree
  * @param temPath pointer to a TraversingPath
+*/
+void markPathVertices(const Graph* myGraph, QueryContext* context, TraversingPath* temPath)
+{
+	markPathNodeVertices(myGraph, context, &context->pathMark, temPath->lastNode);
+}
+
+/**
+ * Check whether the path marked by markPathVertices() passes through a vertex
+ * If it goes through, return false, otherwise return true
+ * @param context pointer to the query context
  * @param vertexID vertex ID to be checked
  * @return If it goes through, return false, otherwise return true
 */
-bool checkIfAccess(Graph* myGraph, TraversingPath* temPath, const int vertexID)
+bool checkIfAccess(const QueryContext* context, const int vertexID)
 {
-	for (unsigned int i = 0; i < temPath->edges.size(); i++)
-	{
-		int firstVertexID = myGraph->edgesVector[temPath->edges[i]].firstVertexID;
-		int secVertexID   = myGraph->edgesVector[temPath->edges[i]].secVertexID;
-		if ((firstVertexID == vertexID) || (secVertexID == vertexID))
-		{
-			return false;
-		}
-	}
-	return true;
+	return !isVertexMarked(&context->pathMark, vertexID);
 }
 
 /**
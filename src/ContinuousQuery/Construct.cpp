@@ -6,13 +6,198 @@
 #include <ctime>
 #include <fstream>
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
 
 #include "../../include/ContinuousQuery/Base.h"
 #include "../../include/ContinuousQuery/Common.h"
 #include "../../include/ContinuousQuery/Construct.h"
 
+namespace
+{
+
+const unsigned int HILBERT_CELLS = 1 << 16;
+
+/**
+ * Round a size up to a multiple of 8, so that every array in the binary graph file stays aligned
+ * @param size size in bytes
+ * @return the rounded size
+*/
+size_t alignSize(const size_t size)
+{
+	return (size + 7) & ~((size_t)7);
+}
+
+/**
+ * Write an array to the binary graph file, padded with zeros to a multiple of 8 bytes
+ * @param fp the binary graph file
+ * @param data start of the array
+ * @param size size of the array in bytes
+ * @return true if everything is written
+*/
+bool writeSection(FILE* fp, const void* data, const size_t size)
+{
+	static const char padding[8] = {0};
+	size_t padSize = alignSize(size) - size;
+	if ((size > 0) && (fwrite(data, 1, size, fp) != size))
+	{
+		return false;
+	}
+	return (padSize == 0) || (fwrite(padding, 1, padSize, fp) == padSize);
+}
+
+/**
+ * Position of a grid cell on a Hilbert curve that covers HILBERT_CELLS x HILBERT_CELLS cells
+ * @param x column of the cell
+ * @param y row of the cell
+ * @return the number of cells before this one on the curve
+*/
+unsigned long long hilbertIndex(unsigned int x, unsigned int y)
+{
+	unsigned long long index = 0;
+	for (unsigned int s = HILBERT_CELLS / 2; s > 0; s /= 2)
+	{
+		unsigned int rx = ((x & s) > 0) ? 1 : 0;
+		unsigned int ry = ((y & s) > 0) ? 1 : 0;
+		index += (unsigned long long)s * s * ((3 * rx) ^ ry);
+		// rotate the quadrant so that the curve inside it starts and ends at the right corners
+		if (ry == 0)
+		{
+			if (rx == 1)
+			{
+				x = HILBERT_CELLS - 1 - x;
+				y = HILBERT_CELLS - 1 - y;
+			}
+			std::swap(x, y);
+		}
+	}
+	return index;
+}
+
+/**
+ * Check whether a character separates the numbers of a line
+ * @param c the character
+ * @return true if c is a separator
+*/
+bool isSeparator(const char c)
+{
+	return (c == ' ') || (c == '|') || (c == '\t') || (c == '\r');
+}
+
+/**
+ * Parse the lines of a chunk of a text file, each line starts with numOfColumn numbers
+ * Numbers after the first numOfColumn ones are ignored, lines with fewer numbers are skipped
+ * @param begin start of the chunk, at the beginning of a line
+ * @param end end of the chunk, at the beginning of a line or the end of the file, which is followed by '\0'
+ * @param numOfColumn the number of numbers read from each line
+ * @param values the numbers of the lines one after another, this variable is the return value
+*/
+void parseNumberLines(const char* begin, const char* end, const int numOfColumn, std::vector<double>* values)
+{
+	std::vector<double> lineValues(numOfColumn);
+	const char* p = begin;
+	while (p < end)
+	{
+		int column = 0;
+		while (column < numOfColumn)
+		{
+			while (isSeparator(*p))
+			{
+				p++;
+			}
+			if ((p >= end) || (*p == '\n'))
+			{
+				break;
+			}
+			char* next;
+			lineValues[column] = strtod(p, &next);
+			if (next == p)
+			{
+				break;
+			}
+			p = next;
+			column++;
+		}
+		if (column == numOfColumn)
+		{
+			values->insert(values->end(), lineValues.begin(), lineValues.end());
+		}
+		const char* lineEnd = (p < end) ? (const char*)memchr(p, '\n', end - p) : NULL;
+		p = (lineEnd == NULL) ? end : lineEnd + 1;
+	}
+}
+
+/**
+ * Read the numbers at the start of each line of a text file
+ * The file is split into chunks at line boundaries, the chunks are parsed in parallel and
+ * their numbers are joined in the order of the chunks, so the result is the same as reading line by line
+ * @param filePath the file path of the text file
+ * @param numOfColumn the number of numbers read from each line
+ * @param values the numbers of the lines one after another, this variable is the return value
+ * @return false if the file cannot be read
+*/
+bool readNumberLines(const std::string filePath, const int numOfColumn, std::vector<double>& values)
+{
+	FILE* fp = fopen(filePath.c_str(), "rb");
+	if (!fp)
+	{
+		return false;
+	}
+	std::vector<char> buffer;
+	char   block[1 << 16];
+	size_t readSize;
+	while ((readSize = fread(block, 1, sizeof(block), fp)) > 0)
+	{
+		buffer.insert(buffer.end(), block, block + readSize);
+	}
+	fclose(fp);
+	const size_t fileSize = buffer.size();
+	buffer.push_back('\0');
+
+	// a chunk of at least 1MB for each thread
+	const size_t minChunkSize = 1 << 20;
+	int numOfChunk = (std::max)(1u, std::thread::hardware_concurrency());
+	numOfChunk = (int)(std::min)((size_t)numOfChunk, fileSize / minChunkSize + 1);
+	std::vector<const char*> chunkStart(numOfChunk + 1);
+	const char* data = buffer.data();
+	chunkStart[0] = data;
+	for (int i = 1; i < numOfChunk; i++)
+	{
+		const char* p = (std::max)(data + fileSize * i / numOfChunk, chunkStart[i - 1]);
+		const char* lineEnd = (const char*)memchr(p, '\n', data + fileSize - p);
+		chunkStart[i] = (lineEnd == NULL) ? data + fileSize : lineEnd + 1;
+	}
+	chunkStart[numOfChunk] = data + fileSize;
+
+	std::vector<std::vector<double> > chunkValues(numOfChunk);
+	std::vector<std::thread> threads;
+	for (int i = 1; i < numOfChunk; i++)
+	{
+		threads.push_back(std::thread(parseNumberLines, chunkStart[i], chunkStart[i + 1], numOfColumn, &chunkValues[i]));
+	}
+	parseNumberLines(chunkStart[0], chunkStart[1], numOfColumn, &chunkValues[0]);
+	for (unsigned int i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+	values.clear();
+	for (int i = 0; i < numOfChunk; i++)
+	{
+		values.insert(values.end(), chunkValues[i].begin(), chunkValues[i].end());
+	}
+	return true;
+}
+
+}
+
 /**
  * Read vertex information from a file
+ * The vertex array is sized to the number of vertices in the file
  * @param myGraph pointer to a graph
  * @param nodeFilePath the file path of the vertex file
  * When reading the vertex in the file, the structure of each line is required to be:
@@ -28,39 +213,27 @@
 void readVertexs(Graph* myGraph, const std::string nodeFilePath)
 {
 	printf("Reading vertex information from file...\n");
-	int   count = 0;
-	char  line[100];
-	FILE* fp;
-	char* p;
-	fp = fopen(nodeFilePath.c_str(), "r");
-	if (!fp)
+	std::vector<double> values;
+	if (!readNumberLines(nodeFilePath, 3, values))
 	{
 		printf("Error when reading vertex file...\n");
 	}
-	else
+	myGraph->vertexPos     = values.size() / 3;
+	myGraph->vertexsVector = new Vertex[myGraph->vertexPos];
+	myGraph->xOfVertex     = new double[myGraph->vertexPos];
+	myGraph->yOfVertex     = new double[myGraph->vertexPos];
+	for (int i = 0; i < myGraph->vertexPos; i++)
 	{
-		myGraph->vertexPos = 0;
-		while (fgets(line, 100, fp) != NULL)
-		{
-			p = strtok(line, " |\t");
-			int ID = atoi(p);
-			p = strtok(NULL, " |\t");
-			double latitude = atof(p);
-			p = strtok(NULL, " |\t");
-			double longitude = atof(p);
-			myGraph->vertexsVector[myGraph->vertexPos].vertexID  = ID;
-			myGraph->vertexsVector[myGraph->vertexPos].longitude = longitude;
-			myGraph->vertexsVector[myGraph->vertexPos].latitude  = latitude;
-			myGraph->vertexPos += 1;
-			count++;
-		}
+		myGraph->vertexsVector[i].vertexID = (int)values[3 * i];
+		myGraph->yOfVertex[i] = values[3 * i + 1];
+		myGraph->xOfVertex[i] = values[3 * i + 2];
 	}
-	fclose(fp);
-	printf("Finish reading vertex information from file---A total of %d vertex are read!!!\n", count);
+	printf("Finish reading vertex information from file---A total of %d vertex are read!!!\n", myGraph->vertexPos);
 }
 
 /**
  * Read edge information from a file
+ * The edge array is sized to the number of edges in the file
  * @param myGraph pointer to a graph
  * @param edgeFilePath the file path of the edge file
  * When reading the edge in the file, the structure of each line is required to be:
@@ -76,46 +249,144 @@ void readVertexs(Graph* myGraph, const std::string nodeFilePath)
 void readEdges(Graph* myGraph, const std::string edgeFilePath)
 {
 	printf("Reading edge information from file...\n");
-	int   count = 0;
-	char  line[300];
-	FILE* fp;
-	char* p;
-	fp = fopen(edgeFilePath.c_str(), "r");
-	if (!fp)
+	std::vector<double> values;
+	if (!readNumberLines(edgeFilePath, 3, values))
 	{
 		printf("Error when reading edge file...\n");
 	}
-	else
+	myGraph->edgePos     = values.size() / 3;
+	myGraph->edgesVector = new Edge[myGraph->edgePos];
+	myGraph->edgeOfOriginalID = new int[myGraph->edgePos];
+	for (int i = 0; i < myGraph->edgePos; i++)
 	{
-		myGraph->edgePos = 0;
-		while (fgets(line, 300, fp) != NULL)
-		{
-			p = strtok(line, " |\t");
-			p = strtok(NULL, " |\t");
-			int startVertexID = atoi(p);
-			p = strtok(NULL, " |\t");
-			int stopVertexID = atoi(p);
-
-			myGraph->edgesVector[myGraph->edgePos].edgeID        = count;
-			myGraph->edgesVector[myGraph->edgePos].firstVertexID = startVertexID;
-			myGraph->edgesVector[myGraph->edgePos].secVertexID   = stopVertexID;
-			setEdgeLength(myGraph, &(myGraph->edgesVector[myGraph->edgePos]));
-
-			myGraph->edgePos += 1;
-			myGraph->vertexsVector[startVertexID].adjVertexID.push_back(stopVertexID);
-			myGraph->vertexsVector[startVertexID].adjEdgeID.push_back(count);
-			myGraph->vertexsVector[stopVertexID].adjVertexID.push_back(startVertexID);
-			myGraph->vertexsVector[stopVertexID].adjEdgeID.push_back(count);
-			count++;
-		}
+		Edge* temEdge = &(myGraph->edgesVector[i]);
+		temEdge->edgeID        = i;
+		temEdge->firstVertexID = (int)values[3 * i + 1];
+		temEdge->secVertexID   = (int)values[3 * i + 2];
+		setEdgeLength(myGraph, temEdge);
+		myGraph->edgeOfOriginalID[i] = i;
 	}
-	fclose(fp);
-	printf("Finish reading edge information from file---A total of %d edge are read!!!\n", count);
+	printf("Finish reading edge information from file---A total of %d edge are read!!!\n", myGraph->edgePos);
+}
+
+/**
+ * Build the adjacency and the edge table of a graph from its edges
+ * The neighbors of each vertex are listed in the order of the edges
+ * @param myGraph pointer to a graph
+*/
+void setAdjacency(Graph* myGraph)
+{
+	// count the neighbors of each vertex first, then fill them in
+	myGraph->adjStart = new int[myGraph->vertexPos + 1];
+	std::fill(myGraph->adjStart, myGraph->adjStart + myGraph->vertexPos + 1, 0);
+	for (int i = 0; i < myGraph->edgePos; i++)
+	{
+		myGraph->adjStart[myGraph->edgesVector[i].firstVertexID + 1]++;
+		myGraph->adjStart[myGraph->edgesVector[i].secVertexID + 1]++;
+	}
+	for (int i = 0; i < myGraph->vertexPos; i++)
+	{
+		myGraph->adjStart[i + 1] += myGraph->adjStart[i];
+	}
+	myGraph->adjacency = new int[2 * myGraph->adjStart[myGraph->vertexPos] + 1];
+	std::vector<int> adjPos(myGraph->adjStart, myGraph->adjStart + myGraph->vertexPos);
+	for (int i = 0; i < myGraph->edgePos; i++)
+	{
+		int startVertexID = myGraph->edgesVector[i].firstVertexID;
+		int stopVertexID  = myGraph->edgesVector[i].secVertexID;
+		myGraph->adjacency[2 * adjPos[startVertexID]]     = stopVertexID;
+		myGraph->adjacency[2 * adjPos[startVertexID] + 1] = i;
+		adjPos[startVertexID]++;
+		myGraph->adjacency[2 * adjPos[stopVertexID]]      = startVertexID;
+		myGraph->adjacency[2 * adjPos[stopVertexID] + 1]  = i;
+		adjPos[stopVertexID]++;
+	}
+	setEdgeTable(myGraph);
+}
+
+/**
+ * Renumber the vertices along a Hilbert curve over their coordinates and the edges in the order of their vertices,
+ * so that vertices and edges that are close on the road network are mostly close in memory as well
+ * The mapping from the edge IDs of the input files is kept in the graph, the adjacency has to be built afterwards
+ * @param myGraph pointer to a graph
+*/
+void reorderGraph(Graph* myGraph)
+{
+	printf("Renumbering the vertices and edges along a Hilbert curve...\n");
+	const int vertexPos = myGraph->vertexPos;
+	const int edgePos   = myGraph->edgePos;
+	if (vertexPos == 0)
+	{
+		return;
+	}
+	double minX = myGraph->xOfVertex[0], maxX = myGraph->xOfVertex[0];
+	double minY = myGraph->yOfVertex[0], maxY = myGraph->yOfVertex[0];
+	for (int i = 1; i < vertexPos; i++)
+	{
+		minX = std::min(minX, myGraph->xOfVertex[i]);
+		maxX = std::max(maxX, myGraph->xOfVertex[i]);
+		minY = std::min(minY, myGraph->yOfVertex[i]);
+		maxY = std::max(maxY, myGraph->yOfVertex[i]);
+	}
+	double range = std::max(maxX - minX, maxY - minY);
+	double scale = (range > 0) ? (HILBERT_CELLS - 1) / range : 0;
+
+	// sort the vertices by their position on the curve, ties keep the order of the file
+	std::vector<std::pair<unsigned long long, int> > vertexOrder(vertexPos);
+	for (int i = 0; i < vertexPos; i++)
+	{
+		unsigned int x = (unsigned int)((myGraph->xOfVertex[i] - minX) * scale);
+		unsigned int y = (unsigned int)((myGraph->yOfVertex[i] - minY) * scale);
+		vertexOrder[i] = std::make_pair(hilbertIndex(x, y), i);
+	}
+	std::sort(vertexOrder.begin(), vertexOrder.end());
+	std::vector<int> newVertexID(vertexPos);
+	Vertex* vertexsVector = new Vertex[vertexPos];
+	double* xOfVertex     = new double[vertexPos];
+	double* yOfVertex     = new double[vertexPos];
+	for (int i = 0; i < vertexPos; i++)
+	{
+		int oldID = vertexOrder[i].second;
+		newVertexID[oldID] = i;
+		vertexsVector[i] = myGraph->vertexsVector[oldID];
+		xOfVertex[i]     = myGraph->xOfVertex[oldID];
+		yOfVertex[i]     = myGraph->yOfVertex[oldID];
+	}
+	delete[] myGraph->vertexsVector;
+	delete[] myGraph->xOfVertex;
+	delete[] myGraph->yOfVertex;
+	myGraph->vertexsVector = vertexsVector;
+	myGraph->xOfVertex     = xOfVertex;
+	myGraph->yOfVertex     = yOfVertex;
+
+	// sort the edges by their renumbered vertices, ties keep the order of the file
+	std::vector<std::pair<std::pair<int, int>, int> > edgeOrder(edgePos);
+	for (int i = 0; i < edgePos; i++)
+	{
+		int firstVertexID = newVertexID[myGraph->edgesVector[i].firstVertexID];
+		int secVertexID   = newVertexID[myGraph->edgesVector[i].secVertexID];
+		edgeOrder[i] = std::make_pair(std::make_pair(std::min(firstVertexID, secVertexID), std::max(firstVertexID, secVertexID)), i);
+	}
+	std::sort(edgeOrder.begin(), edgeOrder.end());
+	Edge* edgesVector = new Edge[edgePos];
+	for (int i = 0; i < edgePos; i++)
+	{
+		int oldID = edgeOrder[i].second;
+		edgesVector[i] = myGraph->edgesVector[oldID];
+		edgesVector[i].edgeID        = i;
+		edgesVector[i].firstVertexID = newVertexID[edgesVector[i].firstVertexID];
+		edgesVector[i].secVertexID   = newVertexID[edgesVector[i].secVertexID];
+		myGraph->edgeOfOriginalID[oldID] = i;
+	}
+	delete[] myGraph->edgesVector;
+	myGraph->edgesVector = edgesVector;
+	printf("Finish renumbering---%d vertex and %d edge are renumbered!!!\n", vertexPos, edgePos);
 }
 
 /**
  * Read reference path information from a file
  * @param myGraph pointer to a graph
+ * @param context pointer to the query context, the vertices of the reference path are marked in it
  * @param referencePath pointer to a reference path
  * @param referFilePath the file path of the reference path file
  * When reading the reference path in the file, the structure of each line is required to be:
@@ -128,31 +399,21 @@ void readEdges(Graph* myGraph, const std::string edgeFilePath)
  * 471		300		301
  * ...
 */
-void readReferencePath(Graph* myGraph, ReferencePath* referencePath, const std::string referFilePath)
+void readReferencePath(const Graph* myGraph, QueryContext* context, ReferencePath* referencePath, const std::string referFilePath)
 {
 	printf("Reading reference path information from file...\n");
-	int   count = 0;
-	char  line[200];
-	FILE* fp;
-	char* p;
-	fp = fopen(referFilePath.c_str(), "r");
-	if (!fp)
+	std::vector<double> values;
+	if (!readNumberLines(referFilePath, 1, values))
 	{
 		printf("Error when reading reference path file...\n");
 	}
-	else
+	for (unsigned int i = 0; i < values.size(); i++)
 	{
-		while (fgets(line, 200, fp) != NULL)
-		{
-			p = strtok(line, " |\t");
-			int pos = atoi(p);
-			referencePath->edges.push_back(myGraph->edgesVector[pos]);
-			myGraph->vertexsVector[myGraph->edgesVector[pos].firstVertexID].referFlag = true;
-			myGraph->vertexsVector[myGraph->edgesVector[pos].secVertexID].referFlag   = true;
-			count++;
-		}
+		int pos = myGraph->edgeOfOriginalID[(int)values[i]];
+		referencePath->edges.push_back(myGraph->edgesVector[pos]);
+		setVertexMark(&context->referMark, myGraph->edgesVector[pos].firstVertexID);
+		setVertexMark(&context->referMark, myGraph->edgesVector[pos].secVertexID);
 	}
-	fclose(fp);
 	printf("Finish reading reference path information from file!!!\n");
 }
 
@@ -171,26 +432,175 @@ void readReferencePath(Graph* myGraph, ReferencePath* referencePath, const std::
  * 471		300		301
  * ...
 */
-void readCompletePath(Graph* myGraph, CompletePath* completePath, const std::string comFilePath)
+void readCompletePath(const Graph* myGraph, CompletePath* completePath, const std::string comFilePath)
 {
-	int   count = 0;
-	char  line[200];
-	FILE* fp;
-	char* p;
-	fp = fopen(comFilePath.c_str(), "r");
-	if (!fp)
+	std::vector<double> values;
+	if (!readNumberLines(comFilePath, 1, values))
 	{
 		printf("Error when reading complete path file...\n");
 	}
-	else
+	for (unsigned int i = 0; i < values.size(); i++)
 	{
-		while (fgets(line, 200, fp) != NULL)
-		{
-			p = strtok(line, " |\t");
-			int pos = atoi(p);
-			completePath->edges.push_back(myGraph->edgesVector[pos]);
-			count++;
-		}
+		completePath->edges.push_back(myGraph->edgesVector[myGraph->edgeOfOriginalID[(int)values[i]]]);
 	}
-	fclose(fp);
+}
+
+/**
+ * Write the vertices, edges, adjacency, edge table and edge ID mapping of a graph to a binary graph file
+ * The edge lengths are stored as they are, so a graph that is projected has to be written with planarFlag set
+ * @param myGraph pointer to a graph
+ * @param binFilePath the file path of the binary graph file
+ * @return true if the file is written
+*/
+bool writeBinaryGraph(const Graph* myGraph, const std::string binFilePath)
+{
+	printf("Writing the road network to the binary graph file...\n");
+	FILE* fp = fopen(binFilePath.c_str(), "wb");
+	if (!fp)
+	{
+		printf("Error when writing binary graph file...\n");
+		return false;
+	}
+	BinaryGraphHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, BINARY_GRAPH_MAGIC, sizeof(header.magic));
+	header.version        = BINARY_GRAPH_VERSION;
+	header.planarFlag     = myGraph->planarFlag ? 1 : 0;
+	header.reorderFlag    = myGraph->reorderFlag ? 1 : 0;
+	header.vertexPos      = myGraph->vertexPos;
+	header.edgePos        = myGraph->edgePos;
+	header.numOfAdjacency = myGraph->adjStart[myGraph->vertexPos];
+	header.edgeTableSize  = myGraph->edgeTableMask + 1;
+	header.vertexSize     = sizeof(Vertex);
+	header.edgeSize       = sizeof(Edge);
+
+	// the padding inside Edge is zeroed, so the same graph always gives the same file
+	std::vector<Edge> edges(myGraph->edgePos);
+	memset(edges.data(), 0, sizeof(Edge) * edges.size());
+	for (int i = 0; i < myGraph->edgePos; i++)
+	{
+		edges[i].edgeID        = myGraph->edgesVector[i].edgeID;
+		edges[i].firstVertexID = myGraph->edgesVector[i].firstVertexID;
+		edges[i].secVertexID   = myGraph->edgesVector[i].secVertexID;
+		edges[i].length        = myGraph->edgesVector[i].length;
+		edges[i].realLength    = myGraph->edgesVector[i].realLength;
+	}
+	bool writeFlag = writeSection(fp, &header, sizeof(header))
+		&& writeSection(fp, myGraph->vertexsVector, sizeof(Vertex) * myGraph->vertexPos)
+		&& writeSection(fp, myGraph->xOfVertex, sizeof(double) * myGraph->vertexPos)
+		&& writeSection(fp, myGraph->yOfVertex, sizeof(double) * myGraph->vertexPos)
+		&& writeSection(fp, edges.data(), sizeof(Edge) * myGraph->edgePos)
+		&& writeSection(fp, myGraph->adjStart, sizeof(int) * (myGraph->vertexPos + 1))
+		&& writeSection(fp, myGraph->adjacency, sizeof(int) * 2 * header.numOfAdjacency)
+		&& writeSection(fp, myGraph->edgeTable, sizeof(int) * header.edgeTableSize)
+		&& writeSection(fp, myGraph->edgeOfOriginalID, sizeof(int) * myGraph->edgePos);
+	if (fclose(fp) != 0)
+	{
+		writeFlag = false;
+	}
+	if (!writeFlag)
+	{
+		printf("Error when writing binary graph file...\n");
+		return false;
+	}
+	printf("Finish writing the binary graph file---%d vertex and %d edge are written!!!\n", myGraph->vertexPos, myGraph->edgePos);
+	return true;
+}
+
+/**
+ * Map a binary graph file into memory and point the vertex, edge, adjacency, edge table and edge ID mapping of a graph into it
+ * Nothing is parsed or copied, the file is mapped read only and stays mapped as long as the graph is used
+ * @param myGraph pointer to a graph
+ * @param binFilePath the file path of the binary graph file
+ * @param planarFlag whether the vertices have to be projected into a local plane in meters
+ * @param reorderFlag whether the vertices and edges have to be renumbered along a Hilbert curve
+ * @return true if the graph is mapped, false if the file does not exist or does not fit this program, planarFlag or reorderFlag
+*/
+bool mapBinaryGraph(Graph* myGraph, const std::string binFilePath, const bool planarFlag, const bool reorderFlag)
+{
+	int fd = open(binFilePath.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	printf("Mapping the road network from the binary graph file...\n");
+	struct stat fileStat;
+	if ((fstat(fd, &fileStat) != 0) || ((size_t)fileStat.st_size < sizeof(BinaryGraphHeader)))
+	{
+		close(fd);
+		printf("The binary graph file is too short, the text files are read instead...\n");
+		return false;
+	}
+	size_t fileSize = fileStat.st_size;
+	void*  data     = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+	{
+		printf("Error when mapping binary graph file, the text files are read instead...\n");
+		return false;
+	}
+
+	const BinaryGraphHeader* header = (const BinaryGraphHeader*)data;
+	bool validFlag = (memcmp(header->magic, BINARY_GRAPH_MAGIC, sizeof(header->magic)) == 0)
+		&& (header->version == BINARY_GRAPH_VERSION)
+		&& (header->vertexSize == (int)sizeof(Vertex))
+		&& (header->edgeSize == (int)sizeof(Edge))
+		&& (header->vertexPos >= 0) && (header->edgePos >= 0) && (header->numOfAdjacency >= 0)
+		&& (header->edgeTableSize > 0) && ((header->edgeTableSize & (header->edgeTableSize - 1)) == 0);
+	size_t dataSize = alignSize(sizeof(BinaryGraphHeader));
+	if (validFlag)
+	{
+		dataSize += alignSize(sizeof(Vertex) * header->vertexPos)
+			+ 2 * alignSize(sizeof(double) * header->vertexPos)
+			+ alignSize(sizeof(Edge) * header->edgePos)
+			+ alignSize(sizeof(int) * (header->vertexPos + 1))
+			+ alignSize(sizeof(int) * 2 * header->numOfAdjacency)
+			+ alignSize(sizeof(int) * header->edgeTableSize)
+			+ alignSize(sizeof(int) * header->edgePos);
+		validFlag = (dataSize <= fileSize);
+	}
+	if (!validFlag)
+	{
+		munmap(data, fileSize);
+		printf("The binary graph file does not fit this program, the text files are read instead...\n");
+		return false;
+	}
+	if ((header->planarFlag == 1) != planarFlag)
+	{
+		munmap(data, fileSize);
+		printf("The binary graph file is written with another projection mode, the text files are read instead...\n");
+		return false;
+	}
+	if ((header->reorderFlag == 1) != reorderFlag)
+	{
+		munmap(data, fileSize);
+		printf("The binary graph file is written with another order mode, the text files are read instead...\n");
+		return false;
+	}
+
+	char* pos = (char*)data + alignSize(sizeof(BinaryGraphHeader));
+	myGraph->vertexPos     = header->vertexPos;
+	myGraph->edgePos       = header->edgePos;
+	myGraph->planarFlag    = planarFlag;
+	myGraph->reorderFlag   = reorderFlag;
+	myGraph->vertexsVector = (Vertex*)pos;
+	pos += alignSize(sizeof(Vertex) * header->vertexPos);
+	myGraph->xOfVertex     = (double*)pos;
+	pos += alignSize(sizeof(double) * header->vertexPos);
+	myGraph->yOfVertex     = (double*)pos;
+	pos += alignSize(sizeof(double) * header->vertexPos);
+	myGraph->edgesVector   = (Edge*)pos;
+	pos += alignSize(sizeof(Edge) * header->edgePos);
+	myGraph->adjStart      = (int*)pos;
+	pos += alignSize(sizeof(int) * (header->vertexPos + 1));
+	myGraph->adjacency     = (int*)pos;
+	pos += alignSize(sizeof(int) * 2 * header->numOfAdjacency);
+	myGraph->edgeTableMask = header->edgeTableSize - 1;
+	myGraph->edgeTable     = (int*)pos;
+	pos += alignSize(sizeof(int) * header->edgeTableSize);
+	myGraph->edgeOfOriginalID = (int*)pos;
+	myGraph->mappedData    = data;
+	myGraph->mappedSize    = fileSize;
+	printf("Finish mapping the binary graph file---A total of %d vertex and %d edge are mapped!!!\n", myGraph->vertexPos, myGraph->edgePos);
+	return true;
 }
@@ -3,26 +3,109 @@
 #include <cmath>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 
 #include "../../include/ContinuousQuery/Base.h"
 #include "../../include/ContinuousQuery/Common.h"
 #include "../../include/ContinuousQuery/Discrete.h"
 
+namespace
+{
+
+/**
+ * Interpolate an edge in one direction
+ * @param myGraph pointer to a graph
+ * @param temEdge the edge to be interpolated
+ * @param startVertexID the vertex where the interpolation starts
+ * @param stopVertexID the vertex where the interpolation stops, which is excluded
+ * @param pointList the point list, this variable is updated in place
+*/
+void interpolateEdge(const Graph* myGraph, const Edge& temEdge, const int startVertexID, const int stopVertexID, std::vector<Point>& pointList)
+{
+	double x1 = myGraph->xOfVertex[startVertexID];
+	double y1 = myGraph->yOfVertex[startVertexID];
+	double x2 = myGraph->xOfVertex[stopVertexID];
+	double y2 = myGraph->yOfVertex[stopVertexID];
+
+	double xLength = (x2 - x1) * (myGraph->SECTION_LENGTH) / (temEdge.realLength);
+	double yLength = (y2 - y1) * (myGraph->SECTION_LENGTH) / (temEdge.realLength);
+	double x = x1;
+	double y = y1;
+	while (graphRealDistance(myGraph, (x1 - x), (y1 - y), y1) < temEdge.realLength)
+	{
+		Point temPoint;
+		temPoint.x = x;
+		temPoint.y = y;
+		pointList.push_back(temPoint);
+		x += xLength;
+		y += yLength;
+	}
+}
+
+/**
+ * Take room for a number of points from the blocks of an edge sample cache
+ * A new block is started if the last one has not enough room left
+ * @param cache pointer to the edge sample cache
+ * @param numOfPoint the number of points
+ * @return the first point of the room
+*/
+Point* takeSamplePoints(EdgeSampleCache* cache, const int numOfPoint)
+{
+	if (cache->blockFree < numOfPoint)
+	{
+		int blockSize = std::max(numOfPoint, EDGE_SAMPLE_BLOCK);
+		cache->blocks.push_back(new Point[blockSize]);
+		cache->blockPos  = cache->blocks.back();
+		cache->blockFree = blockSize;
+	}
+	Point* temPoint = cache->blockPos;
+	cache->blockPos  += numOfPoint;
+	cache->blockFree -= numOfPoint;
+	return temPoint;
+}
+
+/**
+ * Interpolate an edge in both directions with the SECTION_LENGTH of the graph and store the points in its edge sample cache
+ * @param myGraph pointer to a graph
+ * @param edgeID the ID of the edge
+*/
+void setEdgeSamples(const Graph* myGraph, const int edgeID)
+{
+	EdgeSampleCache* cache = myGraph->edgeSampleCache;
+	const Edge& temEdge = myGraph->edgesVector[edgeID];
+	std::vector<Point> pointList;
+	interpolateEdge(myGraph, temEdge, temEdge.firstVertexID, temEdge.secVertexID, pointList);
+	int numOfForward = pointList.size();
+	interpolateEdge(myGraph, temEdge, temEdge.secVertexID, temEdge.firstVertexID, pointList);
+	Point* temPoint = takeSamplePoints(cache, pointList.size());
+	std::copy(pointList.begin(), pointList.end(), temPoint);
+	cache->samples[2 * edgeID]         = temPoint;
+	cache->sampleCount[2 * edgeID]     = numOfForward;
+	cache->samples[2 * edgeID + 1]     = temPoint + numOfForward;
+	cache->sampleCount[2 * edgeID + 1] = pointList.size() - numOfForward;
+}
+
+}
+
 /**
  * Discrete the reference path
  * @param myGraph pointer to a graph
  * @param temPath reference path that needs to be discrete
 */
-void discreteReferPath(Graph* myGraph, ReferencePath* temPath)
+void discreteReferPath(const Graph* myGraph, ReferencePath* temPath)
 {
 	// printf("Start discretizing the reference path...\n");
 	temPath->numOfReferPoint = 0;
 	std::vector<Point> pointList;
 	pointList = creatTrajPoint(myGraph, temPath->edges, temPath->initialVertex);
+	temPath->xOfRefer.resize(pointList.size());
+	temPath->yOfRefer.resize(pointList.size());
 	for (unsigned int i = 0; i < pointList.size(); i++)
 	{
 		temPath->pointOfRefer[i].x = pointList[i].x;
 		temPath->pointOfRefer[i].y = pointList[i].y;
+		temPath->xOfRefer[i] = pointList[i].x;
+		temPath->yOfRefer[i] = pointList[i].y;
 		temPath->numOfReferPoint += 1;
 	}
 	// printf("Discretization of the reference path completed!!!\n");
@@ -30,60 +113,127 @@ void discreteReferPath(Graph* myGraph, ReferencePath* temPath)
 
 /**
  * Discrete a given path
+ * The points of each edge are taken from the edge sample cache of the graph by a TrajPointIter
  * @param myGraph pointer to a graph
  * @param temPath path that needs to be discrete
  * @param initialVertex starting point of the path
  * @return trajectory points after discrete
 */
-std::vector<Point> creatTrajPoint(Graph* myGraph, std::vector<Edge>& temPath, int initialVertex)
+std::vector<Point> creatTrajPoint(const Graph* myGraph, std::vector<Edge>& temPath, int initialVertex)
 {
 	// printf("Start discretizing the path...\n");
 	std::vector<Point> temPointList;
-	Vertex helpFirst, helpSec;
-	helpFirst.vertexID = initialVertex;
-	for (unsigned int i = 0; i < temPath.size(); i++)
+	TrajPointIter iter;
+	Point temPoint;
+	initTrajPointIter(&iter, myGraph, temPath.data(), temPath.size(), initialVertex, true);
+	while (nextTrajPoint(&iter, &temPoint))
 	{
-		Edge helpEdge = temPath[i];
-		if (helpFirst.vertexID == helpEdge.firstVertexID)
+		temPointList.push_back(temPoint);
+	}
+	// printf("The temPointList's size is :%d\n", temPointList.size());
+	// printf("Discretization of the path completed!!!\n");
+	return temPointList;
+}
+
+/**
+ * Set up an empty edge sample cache for a graph
+ * No edge is interpolated here, an edge is interpolated the first time a TrajPointIter walks it,
+ * so a query only pays for the edges it reaches instead of the whole road network
+ * @param myGraph pointer to a graph
+*/
+void initEdgeSamples(Graph* myGraph)
+{
+	EdgeSampleCache* cache = new EdgeSampleCache;
+	cache->samples     = new const Point*[2 * myGraph->edgePos + 1];
+	cache->sampleCount = new int[2 * myGraph->edgePos + 1];
+	std::fill(cache->samples, cache->samples + 2 * myGraph->edgePos + 1, (const Point*)NULL);
+	std::fill(cache->sampleCount, cache->sampleCount + 2 * myGraph->edgePos + 1, 0);
+	cache->blockPos  = NULL;
+	cache->blockFree = 0;
+	myGraph->edgeSampleCache = cache;
+}
+
+/**
+ * Initialize an iterator over the discrete points of a path given by its edges
+ * @param iter the iterator to be initialized
+ * @param myGraph pointer to a graph
+ * @param edges edges of the path
+ * @param edgeCount the number of edges of the path
+ * @param initialVertex starting point of the path
+ * @param withFinal whether the final vertex of the path is yielded after the last edge
+*/
+void initTrajPointIter(TrajPointIter* iter, const Graph* myGraph, const Edge* edges, const int edgeCount, const int initialVertex, const bool withFinal)
+{
+	iter->myGraph      = myGraph;
+	iter->edges        = edges;
+	iter->edgeIDs      = NULL;
+	iter->edgeCount    = edgeCount;
+	iter->edgePos      = 0;
+	iter->currVertexID = initialVertex;
+	iter->withFinal    = withFinal;
+	iter->finished     = false;
+	iter->samplePos    = NULL;
+	iter->sampleStop   = NULL;
+}
+
+/**
+ * Initialize an iterator over the discrete points of a path given by the ID of its edges
+ * @param iter the iterator to be initialized
+ * @param myGraph pointer to a graph
+ * @param edgeIDs ID of the edges of the path
+ * @param edgeCount the number of edges of the path
+ * @param initialVertex starting point of the path
+ * @param withFinal whether the final vertex of the path is yielded after the last edge
+*/
+void initTrajPointIterByID(TrajPointIter* iter, const Graph* myGraph, const int* edgeIDs, const int edgeCount, const int initialVertex, const bool withFinal)
+{
+	initTrajPointIter(iter, myGraph, NULL, edgeCount, initialVertex, withFinal);
+	iter->edgeIDs = edgeIDs;
+}
+
+/**
+ * Yield the next discrete point of a path
+ * @param iter pointer to the iterator
+ * @param temPoint the next point, this variable is the return value
+ * @return false if all points have been yielded
+*/
+bool nextTrajPoint(TrajPointIter* iter, Point* temPoint)
+{
+	while (iter->samplePos == iter->sampleStop)
+	{
+		if (iter->edgePos == iter->edgeCount)
+		{
+			if (iter->withFinal && !iter->finished)
+			{
+				iter->finished = true;
+				temPoint->x = iter->myGraph->xOfVertex[iter->currVertexID];
+				temPoint->y = iter->myGraph->yOfVertex[iter->currVertexID];
+				return true;
+			}
+			iter->finished = true;
+			return false;
+		}
+		const Edge& temEdge = (iter->edges != NULL) ? iter->edges[iter->edgePos] : iter->myGraph->edgesVector[iter->edgeIDs[iter->edgePos]];
+		int pos = 2 * temEdge.edgeID;
+		if (iter->currVertexID == temEdge.firstVertexID)
 		{
-			helpFirst.longitude = myGraph->vertexsVector[helpEdge.firstVertexID].longitude;
-			helpFirst.latitude  = myGraph->vertexsVector[helpEdge.firstVertexID].latitude;
-			helpSec.longitude   = myGraph->vertexsVector[helpEdge.secVertexID].longitude;
-			helpSec.latitude    = myGraph->vertexsVector[helpEdge.secVertexID].latitude;
-			helpFirst.vertexID  = helpEdge.secVertexID;
+			iter->currVertexID = temEdge.secVertexID;
 		}
 		else
 		{
-			helpFirst.longitude = myGraph->vertexsVector[helpEdge.secVertexID].longitude;
-			helpFirst.latitude  = myGraph->vertexsVector[helpEdge.secVertexID].latitude;
-			helpSec.longitude   = myGraph->vertexsVector[helpEdge.firstVertexID].longitude;
-			helpSec.latitude    = myGraph->vertexsVector[helpEdge.firstVertexID].latitude;
-			helpFirst.vertexID  = helpEdge.firstVertexID;
+			iter->currVertexID = temEdge.firstVertexID;
+			pos += 1;
 		}
-		double x1 = helpFirst.longitude;
-		double y1 = helpFirst.latitude;
-		double x2 = helpSec.longitude;
-		double y2 = helpSec.latitude;
-
-		double xLength = (x2 - x1) * (myGraph->SECTION_LENGTH) / (helpEdge.realLength);
-		double yLength = (y2 - y1) * (myGraph->SECTION_LENGTH) / (helpEdge.realLength);
-		double x = x1;
-		double y = y1;
-		while (realDistance((x1 - x), (y1 - y), y1) < helpEdge.realLength)
+		const EdgeSampleCache* cache = iter->myGraph->edgeSampleCache;
+		if (cache->samples[pos] == NULL)
 		{
-			Point* temPoint = new Point;
-			temPoint->x = x;
-			temPoint->y = y;
-			temPointList.push_back(*temPoint);
-			x += xLength;
-			y += yLength;
+			setEdgeSamples(iter->myGraph, temEdge.edgeID);
 		}
+		iter->samplePos  = cache->samples[pos];
+		iter->sampleStop = cache->samples[pos] + cache->sampleCount[pos];
+		iter->edgePos++;
 	}
-	Point* temPoint = new Point;
-	temPoint->x = helpSec.longitude;
-	temPoint->y = helpSec.latitude;
-	temPointList.push_back(*temPoint);
-	// printf("The temPointList's size is :%d\n", temPointList.size());
-	// printf("Discretization of the path completed!!!\n");
-	return temPointList;
+	*temPoint = *(iter->samplePos);
+	iter->samplePos++;
+	return true;
 }
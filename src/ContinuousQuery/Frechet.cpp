@@ -1,8 +1,15 @@
 #include <float.h>
+#include <algorithm>
+#include <memory>
 #include <cmath>
 #include <stdio.h>
 #include <stdlib.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CTSS_X86_SIMD
+#endif
 
+#include "../../include/ContinuousQuery/Base.h"
 #include "../../include/ContinuousQuery/Common.h"
 #include "../../include/ContinuousQuery/Discrete.h"
 #include "../../include/ContinuousQuery/Frechet.h"
@@ -16,7 +23,7 @@ namespace
  * @param pt2 second point
  * @return the Euclidean distance between two points
 */
-double euc(Point pt1, Point pt2)
+double euc(const Point& pt1, const Point& pt2)
 {
 	double ux, uy;
 	ux = pt1.x - pt2.x;
@@ -50,162 +57,648 @@ double min(double a, double b, double c)
 }
 
 /**
- * Recursively calculate DFD
- * @param ca auxiliary array
- * @param i the first dimension of the array
- * @param j the second dimension of the array
- * @param p first trajectory
- * @param q second trajectory
- * @return DFD between two trajectories
+ * Concatenate the traversing path with the remaining part of the reference path
+ * @param myGraph pointer to a graph
+ * @param context pointer to the query context that holds the path tree
+ * @param temPath pointer to a traversing path, which intersects with referencepath
+ * @param referencePath pointer to a reference path
+ * @param finalPath the complete path, this variable is the return value
+ * @param finalVertexID intersection point of traversing path and reference path
 */
-double dist(std::vector<std::vector<double>>& ca, int i, int j, Point* p, Point* q)
+void fillCompletePath(const Graph* myGraph, const QueryContext* context, TraversingPath* temPath, ReferencePath* referencePath, std::vector<Edge>& finalPath, int finalVertexID)
 {
-	if (ca[i][j] > -1)
+	getPathEdges(myGraph, context, temPath, finalPath);
+	int pos;
+	for (int i = (referencePath->edges.size()) - 1; i >= 0; i--)
 	{
-		return ca[i][j];
+		int firstVertexID = referencePath->edges[i].firstVertexID;
+		int secVertexID   = referencePath->edges[i].secVertexID;
+		if ((firstVertexID == finalVertexID) || (secVertexID == finalVertexID))
+		{
+			pos = i;
+			break;
+		}
 	}
-	else if (i == 0 && j == 0)
+	for (unsigned int i = pos; i < referencePath->edges.size(); i++)
 	{
-		ca[i][j] = euc(p[0], q[0]);
+		finalPath.push_back(referencePath->edges[i]);
 	}
-	else if (i > 0 && j == 0)
+}
+
+/**
+ * Append one point of the first trajectory to the banded dfd row
+ * A cell can only be within delta if the point is within delta of its point of q and one of the
+ * cells it comes from is within delta, so only the cells from the first cell of the last band
+ * up to one past its last cell, and then as long as the cell on the left is within delta, are visited
+ * The distances to the points of q are calculated ahead by pointDistances(), up to the end of the old band at a time
+ * @param row the last row before the point, this variable is updated in place
+ * @param pt the appended point
+ * @param n the length of the second trajectory
+ * @param qx x of the second trajectory
+ * @param qy y of the second trajectory
+ * @param delta the threshold
+ * @return false if every cell of the new row exceeds delta
+*/
+bool appendToRow(DFDRow& row, const Point& pt, const int n, const double* qx, const double* qy, const double delta)
+{
+	if ((row.numOfPoint > 0) && row.cells.empty())
 	{
-		ca[i][j] = max(dist(ca, i - 1, 0, p, q), euc(p[i], q[0]));
+		row.numOfPoint++;
+		return false;
 	}
-	else if (i == 0 && j > 0)
+	// before the first point the only reachable cell is the virtual corner left of and above cell 0
+	const int oldLo = row.numOfPoint == 0 ? 0 : row.lo;
+	const int oldHi = row.numOfPoint == 0 ? -1 : row.lo + (int)row.cells.size() - 1;
+	double diag = row.numOfPoint == 0 ? 0.0 : DBL_MAX;
+	double left = DBL_MAX;
+	int newLo = -1;
+	int newHi = -1;
+	// dists holds the distances from pt to q[distLo] up to q[distHi]
+	double dists[DFD_DIST_BLOCK];
+	int distLo = 0;
+	int distHi = -1;
+	// the new band never starts before the old one, so the cells are rewritten in place behind the reads
+	for (int j = oldLo; (j < n) && ((j <= oldHi + 1) || (left != DBL_MAX)); j++)
 	{
-		ca[i][j] = max(dist(ca, 0, j - 1, p, q), euc(p[0], q[j]));
+		double up   = j <= oldHi ? row.cells[j - oldLo] : DBL_MAX;
+		double best = min(up, diag, left);
+		diag = up;
+		left = DBL_MAX;
+		if (best <= delta)
+		{
+			if (j > distHi)
+			{
+				distLo = j;
+				distHi = (std::min)(n - 1, (std::min)(j + DFD_DIST_BLOCK - 1, (std::max)(oldHi + 1, j + 3)));
+				pointDistances(pt, distHi - distLo + 1, qx + distLo, qy + distLo, dists);
+			}
+			double dist = dists[j - distLo];
+			if (dist <= delta)
+			{
+				left = max(best, dist);
+			}
+		}
+		if (left == DBL_MAX)
+		{
+			continue;
+		}
+		if (newLo == -1)
+		{
+			newLo = j;
+			newHi = j - 1;
+		}
+		if (j - newLo >= (int)row.cells.size())
+		{
+			row.cells.resize(j - newLo + 1);
+		}
+		for (int k = newHi + 1; k < j; k++)
+		{
+			row.cells[k - newLo] = DBL_MAX;
+		}
+		row.cells[j - newLo] = left;
+		newHi = j;
 	}
-	else if (i > 0 && j > 0)
+	row.numOfPoint++;
+	if (newLo == -1)
 	{
-		ca[i][j] = max(
-			min(
-				dist(ca, i - 1, j, p, q),
-				dist(ca, i - 1, j - 1, p, q),
-				dist(ca, i, j - 1, p, q)),
-			euc(p[i], q[j]));
+		row.cells.clear();
+		return false;
 	}
-	else
+	row.lo = newLo;
+	row.cells.resize(newHi - newLo + 1);
+	return true;
+}
+
+/**
+ * The struct of PointArrayIter
+ * Walks an array of points with the same interface as TrajPointIter
+ * @field pos next point to be yielded
+ * @field stop end of the array
+*/
+struct PointArrayIter
+{
+	const Point* pos;
+	const Point* stop;
+};
+
+/**
+ * Yield the next point of an array
+ * @param iter pointer to the iterator
+ * @param temPoint the next point, this variable is the return value
+ * @return false if all points have been yielded
+*/
+bool nextPoint(PointArrayIter* iter, Point* temPoint)
+{
+	if (iter->pos == iter->stop)
 	{
-		ca[i][j] = DBL_MAX;
+		return false;
 	}
-	return ca[i][j];
+	*temPoint = *(iter->pos);
+	iter->pos++;
+	return true;
 }
 
-
+/**
+ * Yield the next discrete point of a path
+ * @param iter pointer to the iterator
+ * @param temPoint the next point, this variable is the return value
+ * @return false if all points have been yielded
+*/
+bool nextPoint(TrajPointIter* iter, Point* temPoint)
+{
+	return nextTrajPoint(iter, temPoint);
 }
 
 /**
- * Calculate the dfd of the two trajectories
- * @param m the length of the first trajectory
+ * Append the points yielded by an iterator to the banded dfd row
+ * @param row the last row before the first yielded point, this variable is updated in place
+ * @param iter iterator over the appended points
  * @param n the length of the second trajectory
- * @param p the first trajectory
- * @param q the senond trajectory
- * @return the dfd of the two trajectories
+ * @param qx x of the second trajectory
+ * @param qy y of the second trajectory
+ * @param delta the threshold
 */
-double dfdDist(const int m, const int n, Point* p, Point* q)
+template <typename PointIter>
+void appendAllToRow(DFDRow& row, PointIter iter, const int n, const double* qx, const double* qy, const double delta)
 {
-	std::vector<std::vector<double>> ca(m, std::vector<double>(n, -1));
-	double temDist = dist(ca, m - 1, n - 1, p, q);
-	return temDist;
+	Point temPoint;
+	while (nextPoint(&iter, &temPoint))
+	{
+		if (!appendToRow(row, temPoint, n, qx, qy, delta))
+		{
+			return;
+		}
+	}
 }
 
 /**
- * Expansion of dfd calculation method
- * Calculate the dfd between traversing path and reference path
- * Call dfdDist() at the bottom
- * @param myGraph pointer to a graph
- * @param temPath pointer to a traversing path, which intersects with referencepath
- * @param referencePath pointer to a reference path
- * @param lastPath the complete path after filling the second half of the traversing path, this variable is the return value 
- * @param finalVertexID intersection point of traversing path and reference path
- * @return the dfd between traversing path and reference path
+ * Continue the dfd rows with the remaining points and decide whether the final dfd is within delta
+ * Stop as soon as the band of the current row is empty, or, unless the dfd itself is asked for, once the last cell of the
+ * row is within delta and all remaining points are within delta of the last point of q
+ * The points are walked twice, first only against the last point of q, then through the rows
+ * @param row the last banded row before the first remaining point, this variable is updated in place
+ * @param iter iterator over the remaining points, the last one is the last point of the first trajectory
+ * @param n the length of the second trajectory
+ * @param qx x of the second trajectory
+ * @param qy y of the second trajectory
+ * @param delta the threshold
+ * @param distFlag whether the rows are continued up to the last point even if the dfd is known to be within delta
+ * @return DBL_MAX if the dfd of the two trajectories exceeds delta, otherwise the dfd if distFlag is true,
+ *         or a value within delta that may be smaller than the dfd if distFlag is false
 */
-double dfdDistBetweenTwoPaths(Graph* myGraph, TraversingPath* temPath, ReferencePath* referencePath, std::vector<Edge>& lastPath, int finalVertexID)
+template <typename PointIter>
+double continueWithin(DFDRow& row, PointIter iter, const int n, const double* qx, const double* qy, const double delta, const bool distFlag)
 {
-	// printf("Start calculating the dfd between a half path and the reference path...\n");
-	std::vector<Edge> finalPath;
-	for (unsigned int i = 0; i < temPath->edges.size(); i++)
+	// tailPos is the first position from which all remaining points are within delta of q[n - 1]
+	PointIter scanIter = iter;
+	Point temPoint;
+	Point lastPoint;
+	lastPoint.x = qx[n - 1];
+	lastPoint.y = qy[n - 1];
+	int m       = 0;
+	int tailPos = 0;
+	while (nextPoint(&scanIter, &temPoint))
 	{
-		finalPath.push_back(myGraph->edgesVector[temPath->edges[i]]);
+		m++;
+		if (euc(temPoint, lastPoint) > delta)
+		{
+			tailPos = m;
+		}
 	}
-	int pos;
-	for (int i = (referencePath->edges.size()) - 1; i >= 0; i--)
+	if (m == 0)
 	{
-		int firstVertexID = referencePath->edges[i].firstVertexID;
-		int secVertexID   = referencePath->edges[i].secVertexID;
-		if ((firstVertexID == finalVertexID) || (secVertexID == finalVertexID))
+		return row.numOfPoint > 0 ? dfdRowCell(row, n - 1) : DBL_MAX;
+	}
+	if (tailPos == m)
+	{
+		return DBL_MAX;
+	}
+	for (int i = 0; nextPoint(&iter, &temPoint); i++)
+	{
+		if (row.numOfPoint > 0)
 		{
-			pos = i;
-			break;
+			if (row.cells.empty())
+			{
+				return DBL_MAX;
+			}
+			if ((!distFlag) && (dfdRowCell(row, n - 1) <= delta) && (tailPos <= i))
+			{
+				return dfdRowCell(row, n - 1);
+			}
 		}
+		appendToRow(row, temPoint, n, qx, qy, delta);
 	}
-	for (unsigned int i = pos; i < referencePath->edges.size(); i++)
+	return dfdRowCell(row, n - 1);
+}
+
+/**
+ * Create an iterator over the part of the complete path after the traversing path
+ * @param myGraph pointer to a graph
+ * @param temPath pointer to a traversing path
+ * @param finalPath the complete path starting with the edges of the traversing path
+ * @return iterator over the trajectory points, the last one is the final vertex of the complete path
+*/
+TrajPointIter restTrajPointIter(const Graph* myGraph, TraversingPath* temPath, std::vector<Edge>& finalPath)
+{
+	TrajPointIter iter;
+	int traversedCount = temPath->numOfEdge;
+	initTrajPointIter(&iter, myGraph, finalPath.data() + traversedCount, finalPath.size() - traversedCount, temPath->finalVertexID, true);
+	return iter;
+}
+
+/**
+ * Signature of one anti-diagonal step of the wavefront DFD
+ * Cell i of the diagonal is stored at position i + 1 of the buffers, position 0 is always DBL_MAX
+ * @param lo first row on the diagonal
+ * @param hi last row on the diagonal
+ * @param qOffset offset added to the row to index the reversed second trajectory
+ * @param px x of the first trajectory
+ * @param py y of the first trajectory
+ * @param qx x of the reversed second trajectory
+ * @param qy y of the reversed second trajectory
+ * @param prev2 the diagonal before the previous one
+ * @param prev1 the previous diagonal
+ * @param cur the diagonal to be filled
+*/
+typedef void (*DiagonalStep)(const int lo, const int hi, const int qOffset, const double* px, const double* py,
+	const double* qx, const double* qy, const double* prev2, const double* prev1, double* cur);
+
+void diagonalStepScalar(const int lo, const int hi, const int qOffset, const double* px, const double* py,
+	const double* qx, const double* qy, const double* prev2, const double* prev1, double* cur)
+{
+	for (int i = lo; i <= hi; i++)
 	{
-		finalPath.push_back(referencePath->edges[i]);
+		double ux = px[i] - qx[qOffset + i];
+		double uy = py[i] - qy[qOffset + i];
+		cur[i + 1] = max(min(prev1[i], prev2[i], prev1[i + 1]), sqrt(ux * ux + uy * uy));
 	}
+}
 
-	lastPath = finalPath;
+#ifdef CTSS_X86_SIMD
+__attribute__((target("sse2")))
+void diagonalStepSSE2(const int lo, const int hi, const int qOffset, const double* px, const double* py,
+	const double* qx, const double* qy, const double* prev2, const double* prev1, double* cur)
+{
+	int i = lo;
+	for (; i + 1 <= hi; i += 2)
+	{
+		__m128d ux   = _mm_sub_pd(_mm_loadu_pd(px + i), _mm_loadu_pd(qx + qOffset + i));
+		__m128d uy   = _mm_sub_pd(_mm_loadu_pd(py + i), _mm_loadu_pd(qy + qOffset + i));
+		__m128d dist = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(ux, ux), _mm_mul_pd(uy, uy)));
+		__m128d best = _mm_min_pd(_mm_min_pd(_mm_loadu_pd(prev1 + i), _mm_loadu_pd(prev2 + i)), _mm_loadu_pd(prev1 + i + 1));
+		_mm_storeu_pd(cur + i + 1, _mm_max_pd(best, dist));
+	}
+	diagonalStepScalar(i, hi, qOffset, px, py, qx, qy, prev2, prev1, cur);
+}
 
-	std::vector<Point> temPointList = creatTrajPoint(myGraph, finalPath, referencePath->initialVertex);
-	Point p[temPointList.size()];
-	for (unsigned int i = 0; i < temPointList.size(); i++)
+__attribute__((target("avx2")))
+void diagonalStepAVX2(const int lo, const int hi, const int qOffset, const double* px, const double* py,
+	const double* qx, const double* qy, const double* prev2, const double* prev1, double* cur)
+{
+	int i = lo;
+	for (; i + 3 <= hi; i += 4)
 	{
-		p[i].x = temPointList[i].x;
-		p[i].y = temPointList[i].y;
+		__m256d ux   = _mm256_sub_pd(_mm256_loadu_pd(px + i), _mm256_loadu_pd(qx + qOffset + i));
+		__m256d uy   = _mm256_sub_pd(_mm256_loadu_pd(py + i), _mm256_loadu_pd(qy + qOffset + i));
+		__m256d dist = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(ux, ux), _mm256_mul_pd(uy, uy)));
+		__m256d best = _mm256_min_pd(_mm256_min_pd(_mm256_loadu_pd(prev1 + i), _mm256_loadu_pd(prev2 + i)), _mm256_loadu_pd(prev1 + i + 1));
+		_mm256_storeu_pd(cur + i + 1, _mm256_max_pd(best, dist));
 	}
-	double temDist = dfdDist(temPointList.size(), referencePath->numOfReferPoint, p, referencePath->pointOfRefer);
-	return temDist;
+	diagonalStepScalar(i, hi, qOffset, px, py, qx, qy, prev2, prev1, cur);
 }
+#endif
 
 /**
- * Calculate the dfd of the two path
- * Call dfdDist() at the bottom
- * @param myGraph pointer to a graph
- * @param finalPath a complete path that can be calculated
- * @param referencePath pointer to a reference path
- * @return the dfd of the two path
+ * Signature of the distances from one point to consecutive points stored as separate x and y arrays
+ * @param x x of the point
+ * @param y y of the point
+ * @param count the number of points
+ * @param qx x of the points
+ * @param qy y of the points
+ * @param dist the distances, this variable is the return value
+*/
+typedef void (*DistanceStep)(const double x, const double y, const int count, const double* qx, const double* qy, double* dist);
+
+void distanceStepScalar(const double x, const double y, const int count, const double* qx, const double* qy, double* dist)
+{
+	for (int i = 0; i < count; i++)
+	{
+		double ux = x - qx[i];
+		double uy = y - qy[i];
+		dist[i] = sqrt(ux * ux + uy * uy);
+	}
+}
+
+#ifdef CTSS_X86_SIMD
+__attribute__((target("sse2")))
+void distanceStepSSE2(const double x, const double y, const int count, const double* qx, const double* qy, double* dist)
+{
+	__m128d px = _mm_set1_pd(x);
+	__m128d py = _mm_set1_pd(y);
+	int i = 0;
+	for (; i + 1 < count; i += 2)
+	{
+		__m128d ux = _mm_sub_pd(px, _mm_loadu_pd(qx + i));
+		__m128d uy = _mm_sub_pd(py, _mm_loadu_pd(qy + i));
+		_mm_storeu_pd(dist + i, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(ux, ux), _mm_mul_pd(uy, uy))));
+	}
+	distanceStepScalar(x, y, count - i, qx + i, qy + i, dist + i);
+}
+
+__attribute__((target("avx2")))
+void distanceStepAVX2(const double x, const double y, const int count, const double* qx, const double* qy, double* dist)
+{
+	__m256d px = _mm256_set1_pd(x);
+	__m256d py = _mm256_set1_pd(y);
+	int i = 0;
+	for (; i + 3 < count; i += 4)
+	{
+		__m256d ux = _mm256_sub_pd(px, _mm256_loadu_pd(qx + i));
+		__m256d uy = _mm256_sub_pd(py, _mm256_loadu_pd(qy + i));
+		_mm256_storeu_pd(dist + i, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(ux, ux), _mm256_mul_pd(uy, uy))));
+	}
+	distanceStepScalar(x, y, count - i, qx + i, qy + i, dist + i);
+}
+#endif
+
+/**
+ * Pick the widest diagonal step supported by the running cpu
+ * @return the selected diagonal step
+*/
+DiagonalStep selectDiagonalStep()
+{
+#ifdef CTSS_X86_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		return diagonalStepAVX2;
+	}
+	if (__builtin_cpu_supports("sse2"))
+	{
+		return diagonalStepSSE2;
+	}
+#endif
+	return diagonalStepScalar;
+}
+
+/**
+ * Pick the widest distance step supported by the running cpu
+ * @return the selected distance step
+*/
+DistanceStep selectDistanceStep()
+{
+#ifdef CTSS_X86_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		return distanceStepAVX2;
+	}
+	if (__builtin_cpu_supports("sse2"))
+	{
+		return distanceStepSSE2;
+	}
+#endif
+	return distanceStepScalar;
+}
+
+/**
+ * Collect the discrete points of a path into separate x and y arrays
+ * @param iter iterator over the discrete points
+ * @param x x of the points, this variable is the return value
+ * @param y y of the points, this variable is the return value
 */
-double DFD(Graph* myGraph, std::vector<Edge> finalPath, ReferencePath* referencePath)
+void splitPoints(TrajPointIter iter, std::vector<double>& x, std::vector<double>& y)
 {
-	std::vector<Point> temPointList;
-	temPointList = creatTrajPoint(myGraph, finalPath, referencePath->initialVertex);
-	Point p[temPointList.size()];
-	for (unsigned int i = 0; i < temPointList.size(); i++)
+	Point temPoint;
+	x.clear();
+	y.clear();
+	while (nextTrajPoint(&iter, &temPoint))
 	{
-		p[i].x = temPointList[i].x;
-		p[i].y = temPointList[i].y;
+		x.push_back(temPoint.x);
+		y.push_back(temPoint.y);
 	}
-	double temDist = dfdDist(temPointList.size(), referencePath->numOfReferPoint, p, referencePath->pointOfRefer);
-	return temDist;
+}
+
+}
+
+/**
+ * Calculate the dfd of the two trajectories whose points are stored as separate x and y arrays
+ * The matrix is filled by anti-diagonals, so that the cells of one diagonal are independent
+ * and are computed several at a time with AVX2 or SSE2 when the cpu supports them
+ * @param m the length of the first trajectory
+ * @param n the length of the second trajectory
+ * @param px x of the first trajectory
+ * @param py y of the first trajectory
+ * @param qx x of the second trajectory
+ * @param qy y of the second trajectory
+ * @return the dfd of the two trajectories
+*/
+double dfdDistSeq(const int m, const int n, const double* px, const double* py, const double* qx, const double* qy)
+{
+	if (m > n)
+	{
+		return dfdDistSeq(n, m, qx, qy, px, py);
+	}
+	static const DiagonalStep diagonalStep = selectDiagonalStep();
+	// the cells of a diagonal walk q backwards, so keep q reversed to load it contiguously
+	std::vector<double> qrx(qx, qx + n);
+	std::vector<double> qry(qy, qy + n);
+	std::reverse(qrx.begin(), qrx.end());
+	std::reverse(qry.begin(), qry.end());
+	std::vector<double> buffer(3 * (m + 1), DBL_MAX);
+	double* prev2 = &buffer[0];
+	double* prev1 = &buffer[m + 1];
+	double* cur   = &buffer[2 * (m + 1)];
+	double ux = px[0] - qx[0];
+	double uy = py[0] - qy[0];
+	cur[1] = sqrt(ux * ux + uy * uy);
+	for (int d = 1; d < m + n - 1; d++)
+	{
+		double* temp = prev2;
+		prev2 = prev1;
+		prev1 = cur;
+		cur   = temp;
+		int lo = d - n + 1 > 0 ? d - n + 1 : 0;
+		int hi = d < m - 1 ? d : m - 1;
+		diagonalStep(lo, hi, n - 1 - d, px, py, &qrx[0], &qry[0], prev2, prev1, cur);
+	}
+	return cur[m];
+}
+
+/**
+ * Calculate the distances from one point to consecutive points stored as separate x and y arrays
+ * The distances are independent, so they are computed several at a time with AVX2 or SSE2 when the cpu supports them
+ * @param pt the point
+ * @param count the number of points
+ * @param qx x of the points
+ * @param qy y of the points
+ * @param dist the distances, this variable is the return value
+*/
+void pointDistances(const Point& pt, const int count, const double* qx, const double* qy, double* dist)
+{
+	static const DistanceStep distanceStep = selectDistanceStep();
+	distanceStep(pt.x, pt.y, count, qx, qy, dist);
+}
+
+/**
+ * Append points of the first trajectory to the last banded dfd row of its prefix
+ * The cells of the row are the dfd between the prefix and each prefix of the second trajectory,
+ * only the cells within delta are kept
+ * @param row the last row of the prefix, this variable is updated in place
+ * @param m the number of appended points
+ * @param p the appended points
+ * @param n the length of the second trajectory
+ * @param qx x of the second trajectory
+ * @param qy y of the second trajectory
+ * @param delta the threshold
+*/
+void extendDFDRow(DFDRow& row, const int m, Point* p, const int n, const double* qx, const double* qy, const double delta)
+{
+	PointArrayIter iter = {p, p + m};
+	appendAllToRow(row, iter, n, qx, qy, delta);
+}
+
+/**
+ * Get a cell of a banded dfd row
+ * @param row the banded row
+ * @param j position of the cell
+ * @return the cell, DBL_MAX if it is outside the band or exceeds delta
+*/
+double dfdRowCell(const DFDRow& row, const int j)
+{
+	if ((j < row.lo) || (j >= row.lo + (int)row.cells.size()))
+	{
+		return DBL_MAX;
+	}
+	return row.cells[j - row.lo];
+}
+
+/**
+ * Decide whether a banded dfd row is nowhere larger than another one
+ * Every cell that is appended later is monotone in the cells of the row,
+ * so the first row then gives a dfd that is not larger than the second one for any continuation
+ * @param first the banded row that may dominate
+ * @param second the other banded row, of a prefix ending at the same point
+ * @return true if no cell of first is larger than the same cell of second
+*/
+bool dfdRowDominates(const DFDRow& first, const DFDRow& second)
+{
+	if ((first.numOfPoint == 0) || (second.numOfPoint == 0))
+	{
+		return (first.numOfPoint == 0) && (second.numOfPoint == 0);
+	}
+	for (unsigned int i = 0; i < second.cells.size(); i++)
+	{
+		if (dfdRowCell(first, second.lo + i) > second.cells[i])
+		{
+			return false;
+		}
+	}
+	return true;
 }
 
 /**
  * Calculate the dfd of the two small path
- * Call dfdDist() at the bottom
+ * Call dfdDistSeq() at the bottom
  * @param myGraph pointer to a graph
  * @param firstPath first small path
  * @param secPath second small path
  * @param initialVertex the common starting point of the two paths
  * @return the dfd of the two small path
 */
-double dfdBetweenTwoLocalPaths(Graph* myGraph, std::vector<Edge>& firstPath, std::vector<Edge>& secPath, int initialVertex)
+double dfdBetweenTwoLocalPaths(const Graph* myGraph, std::vector<Edge>& firstPath, std::vector<Edge>& secPath, int initialVertex)
+{
+	TrajPointIter firstIter, secIter;
+	std::vector<double> px, py, qx, qy;
+	initTrajPointIter(&firstIter, myGraph, firstPath.data(), firstPath.size(), initialVertex, true);
+	initTrajPointIter(&secIter, myGraph, secPath.data(), secPath.size(), initialVertex, true);
+	splitPoints(firstIter, px, py);
+	splitPoints(secIter, qx, qy);
+	return dfdDistSeq(px.size(), qx.size(), &px[0], &py[0], &qx[0], &qy[0]);
+}
+
+/**
+ * Calculate the dfd between traversing path and reference path if it is within delta
+ * Continue the dfd row carried by the traversing path with the rest of the reference path,
+ * so only the appended part is calculated, and the calculation stops as soon as the dfd is known to exceed delta
+ * @param myGraph pointer to a graph
+ * @param context pointer to the query context that holds the path tree
+ * @param temPath pointer to a traversing path, which intersects with referencepath
+ * @param referencePath pointer to a reference path
+ * @param lastPath the complete path after filling the second half of the traversing path, this variable is the return value
+ * @param finalVertexID intersection point of traversing path and reference path
+ * @return the dfd between traversing path and reference path, DBL_MAX if it exceeds delta
+*/
+double dfdWithinBetweenTwoPaths(const Graph* myGraph, const QueryContext* context, TraversingPath* temPath, ReferencePath* referencePath, std::vector<Edge>& lastPath, int finalVertexID)
 {
-	std::vector<Point> firstPointList;
-	std::vector<Point> secPointList;
-	firstPointList = creatTrajPoint(myGraph, firstPath, initialVertex);
-	secPointList   = creatTrajPoint(myGraph, secPath, initialVertex);
-	Point p[firstPointList.size()];
-	Point q[secPointList.size()];
-	for (unsigned int i = 0; i < firstPointList.size(); i++)
+	std::vector<Edge> finalPath;
+	fillCompletePath(myGraph, context, temPath, referencePath, finalPath, finalVertexID);
+	lastPath = finalPath;
+
+	if (!temPath->dfdRow)
 	{
-		p[i].x = firstPointList[i].x;
-		p[i].y = firstPointList[i].y;
+		setPathDFDRow(myGraph, context, temPath, referencePath);
 	}
-	for (unsigned int i = 0; i < secPointList.size(); i++)
+	DFDRow row(*(temPath->dfdRow));
+	return continueWithin(row, restTrajPointIter(myGraph, temPath, finalPath),
+		referencePath->numOfReferPoint, &referencePath->xOfRefer[0], &referencePath->yOfRefer[0], myGraph->delta, true);
+}
+
+/**
+ * Decide whether the dfd of the two path is within delta
+ * The points of the path are streamed against the rows over the reference path
+ * @param myGraph pointer to a graph
+ * @param finalPath a complete path that can be calculated
+ * @param referencePath pointer to a reference path
+ * @param distFlag whether the dfd itself is needed, otherwise the calculation may stop as soon as it is known to be within delta
+ * @return DBL_MAX if the dfd of the two path exceeds delta, otherwise the dfd if distFlag is true, or a value within delta
+*/
+double DFDWithin(const Graph* myGraph, std::vector<Edge>& finalPath, ReferencePath* referencePath, const bool distFlag)
+{
+	TrajPointIter iter;
+	DFDRow row = DFDRow();
+	initTrajPointIter(&iter, myGraph, finalPath.data(), finalPath.size(), referencePath->initialVertex, true);
+	return continueWithin(row, iter, referencePath->numOfReferPoint, &referencePath->xOfRefer[0], &referencePath->yOfRefer[0], myGraph->delta, distFlag);
+}
+
+/**
+ * Calculate the banded dfd row carried by a traversing path from scratch
+ * The row is between the discrete points of the path, except its final vertex, and the reference path
+ * @param myGraph pointer to a graph
+ * @param context pointer to the query context that holds the path tree
+ * @param temPath pointer to a traversing path
+ * @param referencePath pointer to a reference path
+*/
+void setPathDFDRow(const Graph* myGraph, const QueryContext* context, TraversingPath* temPath, ReferencePath* referencePath)
+{
+	TrajPointIter iter;
+	std::vector<int> edgeIDs;
+	getPathEdgeIDs(context, temPath, edgeIDs);
+	initTrajPointIterByID(&iter, myGraph, edgeIDs.data(), edgeIDs.size(), referencePath->initialVertex, false);
+	std::shared_ptr<DFDRow> row = std::make_shared<DFDRow>();
+	appendAllToRow(*row, iter, referencePath->numOfReferPoint, &referencePath->xOfRefer[0], &referencePath->yOfRefer[0], myGraph->delta);
+	temPath->dfdRow = row;
+}
+
+/**
+ * Extend the dfd row carried by a traversing path with the points of its last edge
+ * The row of the old path is shared and left untouched, a new row is created for this path
+ * @param myGraph pointer to a graph
+ * @param context pointer to the query context that holds the path tree
+ * @param temPath pointer to a traversing path, whose row does not include its last edge yet
+ * @param referencePath pointer to a reference path
+ * @param initialVertex the vertex from which the last edge is traversed
+*/
+void extendPathDFDRow(const Graph* myGraph, const QueryContext* context, TraversingPath* temPath, ReferencePath* referencePath, const int initialVertex)
+{
+	if (!temPath->dfdRow)
 	{
-		q[i].x = secPointList[i].x;
-		q[i].y = secPointList[i].y;
+		setPathDFDRow(myGraph, context, temPath, referencePath);
+		return;
 	}
-	return dfdDist(firstPointList.size(), secPointList.size(), p, q);
+	TrajPointIter iter;
+	initTrajPointIterByID(&iter, myGraph, &(context->pathTree[temPath->lastNode].edgeID), 1, initialVertex, false);
+	std::shared_ptr<DFDRow> row = std::make_shared<DFDRow>(*(temPath->dfdRow));
+	appendAllToRow(*row, iter, referencePath->numOfReferPoint, &referencePath->xOfRefer[0], &referencePath->yOfRefer[0], myGraph->delta);
+	temPath->dfdRow = row;
 }
\ No newline at end of file
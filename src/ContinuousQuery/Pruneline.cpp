@@ -108,42 +108,86 @@ std::vector<Sequence> setIncreDecreInterval(double calHelpArray[], TraversingPat
 	return myInterval;
 }
 
+/**
+ * Extend the dfd between a trajectory and a prefix of the reference path by the next reference point
+ * The column is updated in place, cell k becomes the dfd between the first k + 1 points of the
+ * trajectory and the prefix ending at the reference point
+ * The distances to the reference point are independent and are calculated first by pointDistances(),
+ * only the min and max along the column are left to the loop
+ * @param xOfTraj x of the discretized points of the path
+ * @param yOfTraj y of the discretized points of the path
+ * @param referPoint the next point of the reference path
+ * @param dfdColumn the column of the previous prefix, overwritten by the column of the extended prefix
+ * @param distColumn the distances from the points of the path to the reference point, this variable is a buffer
+ * @param firstFlag whether the reference point is the first one of the reference path
+*/
+void extendDFDColumn(const std::vector<double>& xOfTraj, const std::vector<double>& yOfTraj, const Point& referPoint, std::vector<double>& dfdColumn, std::vector<double>& distColumn, const bool firstFlag)
+{
+	pointDistances(referPoint, xOfTraj.size(), &xOfTraj[0], &yOfTraj[0], &distColumn[0]);
+	double diagonal = 0;
+	for (unsigned int k = 0; k < xOfTraj.size(); k++)
+	{
+		double left = dfdColumn[k];
+		double eucDist = distColumn[k];
+		if ((k == 0) && firstFlag)
+		{
+			dfdColumn[k] = eucDist;
+		}
+		else if (k == 0)
+		{
+			dfdColumn[k] = (std::max)(left, eucDist);
+		}
+		else if (firstFlag)
+		{
+			dfdColumn[k] = (std::max)(dfdColumn[k - 1], eucDist);
+		}
+		else
+		{
+			dfdColumn[k] = (std::max)((std::min)((std::min)(dfdColumn[k - 1], left), diagonal), eucDist);
+		}
+		diagonal = left;
+	}
+}
+
 /**
  * Calculate lowerbound in Euclidean space
  * Can only be used in European space
  * The reason is that once it encounters a lowerbound that meets the delta, it returns
+ * The dfd is extended one reference point at a time in a single sweep, and the candidate end positions of all intervals are read as the sweep passes them
  * @param myGraph pointer to a graph
+ * @param context pointer to the query context
  * @param path pointer to a TraversingPath
  * @param record information to be recorded during calculation
  * @param referencePath pointer to a ReferencePath
- * @return A lowerbound that meets the delta
+ * @return A lowerbound that meets the delta, -1 if the path cannot be extended
 */
-double eucLowerBound(Graph* myGraph, TraversingPath* path, Record* record, ReferencePath* referencePath)
+double eucLowerBound(const Graph* myGraph, QueryContext* context, TraversingPath* path, Record* record, ReferencePath* referencePath)
 {
 	printf("Start calculating LowerBound...\n");
 	record->numDFDCal       = 0;
 	record->numTemDiscrete  = 0;
 	record->locationOfRefer = -1;
 
-	if ((myGraph->vertexsVector[path->finalVertexID].locationFlag == false) || (path->maxPos < path->minPos))
+	if ((!isVertexMarked(&context->locationMark, path->finalVertexID)) || (path->maxPos < path->minPos))
 	{
 		return -1.0;
 	}
 
 	std::vector<Edge>  finalPath;
 	std::vector<Point> temPointList;
-	for (unsigned int i = 0; i < path->edges.size(); i++)
-	{
-		finalPath.push_back(myGraph->edgesVector[path->edges[i]]);
-	}
+	getPathEdges(myGraph, context, path, finalPath);
 	temPointList = creatTrajPoint(myGraph, finalPath, referencePath->initialVertex);
 	record->numTemDiscrete = temPointList.size();
+	if (temPointList.empty())
+	{
+		return -1.0;
+	}
 
-	double calHelpArray[10000];
+	std::vector<double> calHelpArray(referencePath->numOfReferPoint + 1, -1.0);
 	for (unsigned int i = path->minPos; i <= path->maxPos; i++)
 	{
-		double x1 = myGraph->vertexsVector[path->finalVertexID].longitude;
-		double y1 = myGraph->vertexsVector[path->finalVertexID].latitude;
+		double x1 = myGraph->xOfVertex[path->finalVertexID];
+		double y1 = myGraph->yOfVertex[path->finalVertexID];
 		double x2 = referencePath->pointOfRefer[i].x;
 		double y2 = referencePath->pointOfRefer[i].y;
 		double eucDist = euc(x1, y1, x2, y2);
@@ -151,58 +195,37 @@ double eucLowerBound(Graph* myGraph, TraversingPath* path, Record* record, Refer
 		{
 			calHelpArray[i] = eucDist;
 		}
-		else
-		{
-			calHelpArray[i] = -1.0;
-		}
 	}
 
-	std::vector<Sequence> myInterval = setIncreDecreInterval(calHelpArray, path);
+	std::vector<Sequence> myInterval = setIncreDecreInterval(&calHelpArray[0], path);
 
+	// the intervals are in increasing order of position, so one sweep over the reference path serves them all
 	double temDist = std::numeric_limits<double>::max();
-	std::vector<std::vector<double>> eucDistance(1000, std::vector<double>(1000, -1));
-	std::vector<std::vector<double>> dfdDistance(1000, std::vector<double>(1000, -1));
+	unsigned int lastPos = temPointList.size() - 1;
+	unsigned int nextReferPos = 0;
+	std::vector<double> xOfTraj(temPointList.size());
+	std::vector<double> yOfTraj(temPointList.size());
+	for (unsigned int i = 0; i < temPointList.size(); i++)
+	{
+		xOfTraj[i] = temPointList[i].x;
+		yOfTraj[i] = temPointList[i].y;
+	}
+	std::vector<double> dfdColumn(temPointList.size());
+	std::vector<double> distColumn(temPointList.size());
 	for (unsigned int i = 0; i < myInterval.size(); i++)
 	{
 		if (myInterval[i].seqFlag == false)
 		{
-			for (unsigned int k = 0; k < temPointList.size(); k++)
+			while (nextReferPos <= myInterval[i].stopPos)
 			{
-				for (unsigned int j = 0; j <= myInterval[i].stopPos; j++)
-				{
-					double x1 = temPointList[k].x;
-					double y1 = temPointList[k].y;
-					double x2 = referencePath->pointOfRefer[j].x;
-					double y2 = referencePath->pointOfRefer[j].y;
-					double eucDist = euc(x1, y1, x2, y2);
-					eucDistance[k][j] = eucDist;
-					if ((k == 0) && (j == 0))
-					{
-						dfdDistance[k][j] = eucDistance[k][j];
-					}
-					else if ((k == 0) && (j != 0))
-					{
-						dfdDistance[k][j] = (std::max)(dfdDistance[k][j - 1], eucDistance[k][j]);
-					}
-					else if ((k != 0) && (j == 0))
-					{
-						dfdDistance[k][j] = (std::max)(dfdDistance[k - 1][j], eucDistance[k][j]);
-					}
-					else
-					{
-						dfdDistance[k][j] = (std::max)(
-							(std::min)((std::min)(dfdDistance[k - 1][j], dfdDistance[k][j - 1]), dfdDistance[k - 1][j - 1]), eucDistance[k][j]);
-					}
-				}
+				extendDFDColumn(xOfTraj, yOfTraj, referencePath->pointOfRefer[nextReferPos], dfdColumn, distColumn, nextReferPos == 0);
+				nextReferPos++;
 			}
-			if (dfdDistance[temPointList.size() - 1][myInterval[i].stopPos] < temDist)
+			double intervalDist = dfdColumn[lastPos];
+			if (intervalDist < temDist)
 			{
 				record->eucConQueryPos = myInterval[i].stopPos;
-			}
-
-			if (dfdDistance[temPointList.size() - 1][myInterval[i].stopPos] < temDist)
-			{
-				temDist = dfdDistance[temPointList.size() - 1][myInterval[i].stopPos];
+				temDist = intervalDist;
 			}
 			record->locationOfRefer = myInterval[i].stopPos;
 			record->numDFDCal += 1;
@@ -213,71 +236,18 @@ double eucLowerBound(Graph* myGraph, TraversingPath* path, Record* record, Refer
 		}
 		else
 		{
-			for (unsigned int k = 0; k <= temPointList.size(); k++)
-			{
-				for (unsigned int j = 0; j < myInterval[i].startPos; j++)
-				{
-					double x1 = temPointList[k].x;
-					double y1 = temPointList[k].y;
-					double x2 = referencePath->pointOfRefer[j].x;
-					double y2 = referencePath->pointOfRefer[j].y;
-					double eucDist = euc(x1, y1, x2, y2);
-					eucDistance[k][j] = eucDist;
-					if ((k == 0) && (j == 0))
-					{
-						dfdDistance[k][j] = eucDistance[k][j];
-					}
-					else if ((k == 0) && (j != 0))
-					{
-						dfdDistance[k][j] = (std::max)(dfdDistance[k][j - 1], eucDistance[k][j]);
-					}
-					else if ((k != 0) && (j == 0))
-					{
-						dfdDistance[k][j] = (std::max)(dfdDistance[k - 1][j], eucDistance[k][j]);
-					}
-					else
-					{
-						dfdDistance[k][j] = (std::max)(
-							(std::min)((std::min)(dfdDistance[k - 1][j], dfdDistance[k][j - 1]), dfdDistance[k - 1][j - 1]), eucDistance[k][j]);
-					}
-				}
-			}
 			record->numDFDCal += 1;
 			for (unsigned int j = myInterval[i].startPos; j <= myInterval[i].stopPos; j++)
 			{
-				for (unsigned int k = 0; k < temPointList.size(); k++)
+				while (nextReferPos <= j)
 				{
-					double x1 = temPointList[k].x;
-					double y1 = temPointList[k].y;
-					double x2 = referencePath->pointOfRefer[j].x;
-					double y2 = referencePath->pointOfRefer[j].y;
-					double eucDist = euc(x1, y1, x2, y2);
-					eucDistance[k][j] = eucDist;
-					if ((k == 0) && (j == 0))
-					{
-						dfdDistance[k][j] = eucDistance[k][j];
-					}
-					else if ((k == 0) && (j != 0))
-					{
-						dfdDistance[k][j] = (std::max)(dfdDistance[k][j - 1], eucDistance[k][j]);
-					}
-					else if ((k != 0) && (j == 0))
-					{
-						dfdDistance[k][j] = (std::max)(dfdDistance[k - 1][j], eucDistance[k][j]);
-					}
-					else
-					{
-						dfdDistance[k][j] = (std::max)(
-							(std::min)((std::min)(dfdDistance[k - 1][j], dfdDistance[k][j - 1]), dfdDistance[k - 1][j - 1]), eucDistance[k][j]);
-					}
+					extendDFDColumn(xOfTraj, yOfTraj, referencePath->pointOfRefer[nextReferPos], dfdColumn, distColumn, nextReferPos == 0);
+					nextReferPos++;
 				}
-				if (dfdDistance[temPointList.size() - 1][j] < temDist)
+				if (dfdColumn[lastPos] < temDist)
 				{
 					record->eucConQueryPos = j;
-				}
-				if (dfdDistance[temPointList.size() - 1][j] < temDist)
-				{
-					temDist = dfdDistance[temPointList.size() - 1][j];
+					temDist = dfdColumn[lastPos];
 				}
 				record->locationOfRefer = j;
 				if (temDist <= (myGraph->delta))
@@ -286,11 +256,11 @@ double eucLowerBound(Graph* myGraph, TraversingPath* path, Record* record, Refer
 				}
 				if (j != myInterval[i].stopPos)
 				{
-					double x1 = temPointList[temPointList.size() - 1].x;
-					double y1 = temPointList[temPointList.size() - 1].y;
+					double x1 = temPointList[lastPos].x;
+					double y1 = temPointList[lastPos].y;
 					double x2 = referencePath->pointOfRefer[j + 1].x;
 					double y2 = referencePath->pointOfRefer[j + 1].y;
-					if (euc(x1, y1, x2, y2) >= dfdDistance[temPointList.size() - 1][j])
+					if (euc(x1, y1, x2, y2) >= dfdColumn[lastPos])
 					{
 						break;
 					}
@@ -301,7 +271,19 @@ double eucLowerBound(Graph* myGraph, TraversingPath* path, Record* record, Refer
 	return temDist;
 }
 
-bool calculateLowerBound(Graph* myGraph, TraversingPath* path, Record* record, ReferencePath* referencePath)
+/**
+ * Calculate lowerbound in road network space
+ * The banded dfd row carried by the path is completed with its final vertex, so that each cell
+ * is the dfd between the path and a prefix of the reference path, then the candidate
+ * end positions of each monotone interval are looked up in that row, cells outside the band exceed delta
+ * @param myGraph pointer to a graph
+ * @param context pointer to the query context
+ * @param path pointer to a TraversingPath
+ * @param record information to be recorded during calculation
+ * @param referencePath pointer to a ReferencePath
+ * @return the lowerbound of the path, -1 if the path cannot be extended
+*/
+double calculateLowerBound(const Graph* myGraph, QueryContext* context, TraversingPath* path, Record* record, ReferencePath* referencePath)
 {
 	printf("Start calculating lower bound...\n");
 	record->numDFDCal = 0;
@@ -313,165 +295,172 @@ bool calculateLowerBound(Graph* myGraph, TraversingPath* path, Record* record, R
 	}
 	else
 	{
-		std::vector<Edge>  finalPath;
-		std::vector<Point> temPointList;
-		for (unsigned int i = 0; i < path->edges.size(); i++)
+		if (!path->dfdRow)
 		{
-			finalPath.push_back(myGraph->edgesVector[path->edges[i]]);
+			setPathDFDRow(myGraph, context, path, referencePath);
 		}
-		temPointList = creatTrajPoint(myGraph, finalPath, referencePath->initialVertex);
-		Point p[(temPointList.size())];
-		for (unsigned int i = 0; i < temPointList.size(); i++)
+		Point finalPoint;
+		finalPoint.x = myGraph->xOfVertex[path->finalVertexID];
+		finalPoint.y = myGraph->yOfVertex[path->finalVertexID];
+		DFDRow dfdRow(*(path->dfdRow));
+		extendDFDRow(dfdRow, 1, &finalPoint, referencePath->numOfReferPoint, &referencePath->xOfRefer[0], &referencePath->yOfRefer[0], myGraph->delta);
+		if (dfdRow.cells.empty())
 		{
-			p[i].x = temPointList[i].x;
-			p[i].y = temPointList[i].y;
+			return -1.0;
 		}
-		printf("123456789\n");
-		double calHelpArray[10000];
+
+		std::vector<double> calHelpArray(referencePath->numOfReferPoint + 1, -1.0);
 		for (unsigned int i = path->minPos; i <= path->maxPos; i++)
 		{
-			double x1 = myGraph->vertexsVector[path->finalVertexID].longitude;
-			double y1 = myGraph->vertexsVector[path->finalVertexID].latitude;
-			double x2 = referencePath->pointOfRefer[i].x;
-			double y2 = referencePath->pointOfRefer[i].y;
-			double eucDist = euc(x1, y1, x2, y2);
+			double eucDist = euc(finalPoint.x, finalPoint.y, referencePath->pointOfRefer[i].x, referencePath->pointOfRefer[i].y);
 			if (eucDist <= (myGraph->delta))
 			{
 				calHelpArray[i] = eucDist;
 			}
-			else
-			{
-				calHelpArray[i] = -1.0;
-			}
 		}
-		std::vector<Sequence> myInterval = setIncreDecreInterval(calHelpArray, path);
-		printf("987654321\n");
-		double   temDist = std::numeric_limits<double>::max();
-		std::vector<std::vector<double>> eucDistance(1000, std::vector<double>(1000, -1));
-		std::vector<std::vector<double>> dfdDistance(1000, std::vector<double>(1000, -1));
+		std::vector<Sequence> myInterval = setIncreDecreInterval(&calHelpArray[0], path);
+		double temDist = std::numeric_limits<double>::max();
 		for (unsigned int i = 0; i < myInterval.size(); i++)
 		{
-			printf("555\n");
 			if (myInterval[i].seqFlag == false)
 			{
-				printf("111\n");
-				double xDist = dfdDist(temPointList.size(), myInterval[i].stopPos + 1, p, referencePath->pointOfRefer);
-				temDist = xDist < temDist ? xDist : temDist;
-				printf("temDist is: %lf\n", temDist);
-				printf("222\n");
+				temDist = (std::min)(dfdRowCell(dfdRow, myInterval[i].stopPos), temDist);
 			}
 			else
 			{
-				printf("666\n");
-				for (unsigned int k = 0; k < temPointList.size(); k++)
-				{
-					for (unsigned int j = 0; j < myInterval[i].startPos; j++)
-					{
-						double x1 = p[k].x;
-						double y1 = p[k].y;
-						double x2 = referencePath->pointOfRefer[j].x;
-						double y2 = referencePath->pointOfRefer[j].y;
-						double eucDist = euc(x1, y1, x2, y2);
-						eucDistance[k][j] = eucDist;
-						if ((k == 0) && (j == 0))
-						{
-							dfdDistance[k][j] = eucDistance[k][j];
-						}
-						else if ((k == 0) && (j != 0))
-						{
-							dfdDistance[k][j] = (std::max)(dfdDistance[k][j - 1], eucDistance[k][j]);
-						}
-						else if ((k != 0) && (j == 0))
-						{
-							dfdDistance[k][j] = (std::max)(dfdDistance[k - 1][j], eucDistance[k][j]);
-						}
-						else
-						{
-							dfdDistance[k][j] = (std::max)(
-								(std::min)((std::min)(dfdDistance[k - 1][j], dfdDistance[k][j - 1]), dfdDistance[k - 1][j - 1]), eucDistance[k][j]);
-						}
-					}
-				}
-				printf("1365\n");
 				for (unsigned int j = myInterval[i].startPos; j <= myInterval[i].stopPos; j++)
 				{
-					for (unsigned int k = 0; k < temPointList.size(); k++)
-					{
-						double x1 = p[k].x;
-						double y1 = p[k].y;
-						double x2 = referencePath->pointOfRefer[j].x;
-						double y2 = referencePath->pointOfRefer[j].y;
-						double eucDist = euc(x1, y1, x2, y2);
-						eucDistance[k][j] = eucDist;
-					}
-					if (dfdDistance[temPointList.size() - 1][j] < temDist)
-					{
-						temDist = dfdDistance[temPointList.size() - 1][j];
-					}
+					temDist = (std::min)(dfdRowCell(dfdRow, j), temDist);
 					if (j != myInterval[i].stopPos)
 					{
-						double x1 = p[temPointList.size() - 1].x;
-						double y1 = p[temPointList.size() - 1].y;
 						double x2 = referencePath->pointOfRefer[j + 1].x;
 						double y2 = referencePath->pointOfRefer[j + 1].y;
-						if (euc(x1, y1, x2, y2) >= dfdDistance[temPointList.size() - 1][j])
+						if (euc(finalPoint.x, finalPoint.y, x2, y2) >= dfdRowCell(dfdRow, j))
 						{
 							break;
 						}
 					}
 				}
-				printf("78978\n");
 			}
-
 		}
-		printf("7894564\n");
-		printf("654\n");
 		printf("final temDist is:%lf\n", temDist);
 		return temDist;
 	}
 }
 
-bool BFS(Graph* myGraph, ReferencePath* referencePath, std::vector<Edge> currentPath, int currentVertex)
+/**
+ * Set the lower bound and the key of a new path and decide whether it can be pushed into the frontier
+ * If handleNewPath() left the dfd row of the last edge to settleLowerBound() in lazy mode, the bound is only estimated
+ * by the larger of the bound of the old path and the distance from the new vertex to the reference path,
+ * both of which are lower bounds of the dfd of every completion of the new path
+ * @param myGraph pointer to a graph
+ * @param context pointer to the query context
+ * @param oldPath the path that is extended, its bound is exact
+ * @param newPath the new path
+ * @param record information to be recorded during calculation
+ * @param referencePath pointer to a ReferencePath
+ * @return true if the bound of the new path is within delta
+*/
+bool setNewPathBound(const Graph* myGraph, QueryContext* context, TraversingPath* oldPath, TraversingPath* newPath, Record* record, ReferencePath* referencePath)
 {
-	printf("Start BFS search...\n");
-	bool bfsFlag[(myGraph->vertexPos)];
-	for (unsigned int i = 0; i < myGraph->vertexPos; i++)
+	double lb;
+	if (newPath->exactBoundFlag)
+	{
+		lb = calculateLowerBound(myGraph, context, newPath, record, referencePath);
+	}
+	else
 	{
-		bfsFlag[i] = false;
+		lb = (std::max)(oldPath->eucDeltaOfTrue, context->distToRefer[newPath->finalVertexID]);
 	}
-	Vertex* firstVertex = new Vertex;
-	firstVertex->vertexID = currentVertex;
-	std::queue<Vertex> queue;
-	queue.push(*firstVertex);
+	if ((lb == -1) || (lb >= (myGraph->delta)))
+	{
+		return false;
+	}
+	newPath->eucDeltaOfTrue = lb;
+	newPath->eucDelta = (100000 * lb + context->traversalOrderWeights[newPath->finalVertexID]);
+	return true;
+}
+
+/**
+ * Extend the dfd row and calculate the exact lower bound of a path taken from the frontier, if they were left out when it was pushed
+ * The label of the path is only added now, as it needs the extended row and the exact bound,
+ * and a path whose key gets worse is pushed again, as other paths may come before it now
+ * @param myGraph pointer to a graph
+ * @param context pointer to the query context
+ * @param temPath the path taken from the frontier
+ * @param record information to be recorded during calculation
+ * @param referencePath pointer to a ReferencePath
+ * @param labelFlag whether the search drops paths dominated by the labels of the context
+ * @return true if the path can be expanded now, false if it is pruned, dominated or pushed again
+*/
+bool settleLowerBound(const Graph* myGraph, QueryContext* context, TraversingPath* temPath, Record* record, ReferencePath* referencePath, const bool labelFlag)
+{
+	if (temPath->exactBoundFlag)
+	{
+		return true;
+	}
+	const Edge& lastEdge = myGraph->edgesVector[context->pathTree[temPath->lastNode].edgeID];
+	int initialVertex = (lastEdge.firstVertexID == temPath->finalVertexID) ? lastEdge.secVertexID : lastEdge.firstVertexID;
+	extendPathDFDRow(myGraph, context, temPath, referencePath, initialVertex);
+	double lb = calculateLowerBound(myGraph, context, temPath, record, referencePath);
+	if ((lb == -1) || (lb >= (myGraph->delta)))
+	{
+		return false;
+	}
+	double key = (100000 * lb + context->traversalOrderWeights[temPath->finalVertexID]);
+	temPath->exactBoundFlag = true;
+	temPath->eucDeltaOfTrue = lb;
+	if (labelFlag && !addPathLabel(myGraph, context, temPath))
+	{
+		return false;
+	}
+	if (key > temPath->eucDelta)
+	{
+		temPath->eucDelta = key;
+		pushPath(context, *temPath);
+		return false;
+	}
+	temPath->eucDelta = key;
+	return true;
+}
+
+bool BFS(const Graph* myGraph, QueryContext* context, ReferencePath* referencePath, std::vector<Edge> currentPath, int currentVertex)
+{
+	printf("Start BFS search...\n");
+	VertexMark* bfsMark = &context->searchMark;
+	const SafeArea* area = &context->safeArea;
+	clearVertexMark(bfsMark);
+	addSafeAreaVertex(myGraph, context, currentVertex);
+	std::queue<int> queue;
+	queue.push(currentVertex);
 	while (!queue.empty())
 	{
-		Vertex temVertex = queue.front();
+		int temVertexID = queue.front();
 		queue.pop();
-		bfsFlag[temVertex.vertexID] = true;
-		if (myGraph->vertexsVector[temVertex.vertexID].referFlag == false)
+		setVertexMark(bfsMark, temVertexID);
+		if (!isVertexMarked(&context->referMark, temVertexID))
 		{
-			for (unsigned int i = 0; i < myGraph->vertexsVector[temVertex.vertexID].adjVertexID.size(); i++)
+			int localVertexID = area->localVertexID[temVertexID];
+			for (int k = area->adjStart[localVertexID]; k < area->adjStart[localVertexID + 1]; k++)
 			{
-				int nextVertexID = myGraph->vertexsVector[temVertex.vertexID].adjVertexID[i];
-				if ((bfsFlag[nextVertexID] == false) && (myGraph->vertexsVector[nextVertexID].currFlag == false) && (myGraph->vertexsVector[nextVertexID].locationFlag == true))
+				int nextVertexID = area->adjacency[2 * k];
+				if ((!isVertexMarked(bfsMark, nextVertexID)) && (!isVertexMarked(&context->currMark, nextVertexID)))
 				{
-					Vertex* newNode = new Vertex;
-					newNode = &(myGraph->vertexsVector[nextVertexID]);
-					newNode->parentVertexID = temVertex.vertexID;
-					bfsFlag[nextVertexID] = true;
-					queue.push(*newNode);
+					context->parentVertexID[nextVertexID] = temVertexID;
+					setVertexMark(bfsMark, nextVertexID);
+					queue.push(nextVertexID);
 				}
 			}
 		}
 		else
 		{
 			std::vector<Edge> temPath;
-			Vertex* newNode;
-			int temID = temVertex.vertexID;
+			int temID = temVertexID;
 			while (temID != currentVertex)
 			{
-				temPath.push_back(findEdge(myGraph, myGraph->vertexsVector[temID], myGraph->vertexsVector[myGraph->vertexsVector[temID].parentVertexID]));
-				temID = myGraph->vertexsVector[temID].parentVertexID;
+				int temParentID = context->parentVertexID[temID];
+				temPath.push_back(findEdge(myGraph, temID, temParentID));
+				temID = temParentID;
 			}
 			std::vector<Edge> finalPath;
 			for (unsigned int i = 0; i < currentPath.size(); i++)
@@ -483,7 +472,7 @@ bool BFS(Graph* myGraph, ReferencePath* referencePath, std::vector<Edge> current
 				finalPath.push_back(temPath[i]);
 			}
 			int pathPos;
-			int finalVertexID = temVertex.vertexID;
+			int finalVertexID = temVertexID;
 			for (int i = referencePath->edges.size() - 1; i >= 0; i--)
 			{
 				if ((referencePath->edges[i].firstVertexID == finalVertexID) || (referencePath->edges[i].secVertexID == finalVertexID))
@@ -496,23 +485,7 @@ bool BFS(Graph* myGraph, ReferencePath* referencePath, std::vector<Edge> current
 			{
 				finalPath.push_back(referencePath->edges[i]);
 			}
-			std::vector<Point> temPointList;
-			temPointList = creatTrajPoint(myGraph, finalPath, referencePath->initialVertex);
-			Point p[temPointList.size()];
-			for (unsigned int i = 0; i < temPointList.size(); i++)
-			{
-				p[i].x = temPointList[i].x;
-				p[i].y = temPointList[i].y;
-			}
-			double temDist = dfdDist(temPointList.size(), referencePath->numOfReferPoint, p, referencePath->pointOfRefer);
-			if (temDist <= (myGraph->delta))
-			{
-				return true;
-			}
-			else
-			{
-				return false;
-			}
+			return DFDWithin(myGraph, finalPath, referencePath, false) <= (myGraph->delta);
 		}
 	}
 	return false;
@@ -520,14 +493,14 @@ bool BFS(Graph* myGraph, ReferencePath* referencePath, std::vector<Edge> current
 
 }
 
-bool eucSimpleQueryPath(Graph* myGraph, ReferencePath* referencePath, std::vector<Edge> currentPath, Record* temRecord, int currentVertex)
+bool eucSimpleQueryPath(const Graph* myGraph, QueryContext* context, ReferencePath* referencePath, std::vector<Edge> currentPath, Record* temRecord, int currentVertex)
 {
 	printf("Start eucSimpleQueryPath...\n");
 	TraversingPath* path = new TraversingPath;
-	initializeFirstPath(myGraph, path, currentVertex, currentPath);
+	initializeFirstPath(context, path, currentVertex, currentPath);
 	if (path->finalVertexID != referencePath->finalVertex)
 	{
-		double lb = eucLowerBound(myGraph, path, temRecord, referencePath);
+		double lb = eucLowerBound(myGraph, context, path, temRecord, referencePath);
 		if ((lb != -1) && (lb < (myGraph->delta)))
 		{
 			delete path;
@@ -542,12 +515,8 @@ bool eucSimpleQueryPath(Graph* myGraph, ReferencePath* referencePath, std::vecto
 	else
 	{
 		std::vector<Edge> finalPath;
-		for (unsigned int i = 0; i < path->edges.size(); i++)
-		{
-			finalPath.push_back(myGraph->edgesVector[path->edges[i]]);
-		}
-		double temDist = DFD(myGraph, finalPath, referencePath);
-		if (temDist <= (myGraph->delta))
+		getPathEdges(myGraph, context, path, finalPath);
+		if (DFDWithin(myGraph, finalPath, referencePath, false) <= (myGraph->delta))
 		{
 			delete path;
 			return true;
@@ -560,69 +529,73 @@ bool eucSimpleQueryPath(Graph* myGraph, ReferencePath* referencePath, std::vecto
 	}
 }
 
-bool roadSimpleQueryPath(Graph* myGraph, ReferencePath* referencePath, std::vector<Edge> currentPath, 
+bool roadSimpleQueryPath(const Graph* myGraph, QueryContext* context, ReferencePath* referencePath, std::vector<Edge> currentPath, 
 	std::vector<Edge>& lastPath, Record* temRecord, int currentVertex, int* timeOutFlag, double* pathDistance)
 {
-	if (!BFS(myGraph, referencePath, currentPath, currentVertex))
+	if (!BFS(myGraph, context, referencePath, currentPath, currentVertex))
 	{
 		printf("BFS search did not get results...\n");
+		const SafeArea* area = &context->safeArea;
 		clock_t startTime, stopTime;
 		startTime = clock();
-		priority_queue<TraversingPath> priorityQueue;
-		TraversingPath* firstPath = new TraversingPath;
-		initializeFirstPath(myGraph, firstPath, currentVertex, currentPath);
-		priorityQueue.push(*firstPath);
+		TraversingPath firstPath;
+		clearPathHeap(context);
+		if (myGraph->labelFlag)
+		{
+			clearPathLabels(context);
+		}
+		initializeFirstPath(context, &firstPath, currentVertex, currentPath);
+		setPathDFDRow(myGraph, context, &firstPath, referencePath);
+		pushPath(context, firstPath);
 		temRecord->numOfOutPriQueue = 0;
-		while (!priorityQueue.empty())																				  
+		while (!context->pathHeap.empty())																				  
 		{
-			TraversingPath* temPath;
 			stopTime = clock();
 			if (((double)(stopTime - startTime) / CLOCKS_PER_SEC) > 10)
 			{
 				(*timeOutFlag) = 1;
-				delete firstPath;
 				return false;
 			}
 
-			(*temPath) = (priorityQueue.top());
-			priorityQueue.pop();
+			TraversingPath* temPath = popPath(context);
+			if (!settleLowerBound(myGraph, context, temPath, temRecord, referencePath, myGraph->labelFlag))
+			{
+				continue;
+			}
 			temRecord->numOfOutPriQueue += 1;
 			
 			if (temPath->finalVertexID != referencePath->finalVertex)
 			{
-				for (unsigned int i = 0; i < (myGraph->vertexsVector[temPath->finalVertexID].adjVertexID.size()); i++)
+				markPathVertices(myGraph, context, temPath);
+				int localVertexID = area->localVertexID[temPath->finalVertexID];
+				for (int k = area->adjStart[localVertexID]; k < area->adjStart[localVertexID + 1]; k++)
 				{
-					int nextVertexID = myGraph->vertexsVector[temPath->finalVertexID].adjVertexID[i];
-					if ((myGraph->vertexsVector[nextVertexID].locationFlag == true) && (checkIfAccess(myGraph, temPath, nextVertexID)))
+					int nextVertexID = area->adjacency[2 * k];
+					if (checkIfAccess(context, nextVertexID))
 					{
-						TraversingPath* newPath = new TraversingPath;
-						handleNewPath(myGraph, temPath, newPath, nextVertexID);
+						TraversingPath newPath;
+						handleNewPath(myGraph, context, temPath, &newPath, nextVertexID, referencePath);
 
-						if ((myGraph->vertexsVector[newPath->finalVertexID].referFlag == true))
+						if (isVertexMarked(&context->referMark, newPath.finalVertexID))
 						{
-							double temDist = dfdDistBetweenTwoPaths(myGraph, newPath, referencePath, lastPath, newPath->finalVertexID);
+							double temDist = dfdWithinBetweenTwoPaths(myGraph, context, &newPath, referencePath, lastPath, newPath.finalVertexID);
 							if (temDist <= (myGraph->delta))
 							{
-								delete firstPath;
-								delete newPath;
 								(*pathDistance) = temDist;
 								return true;
 							}
-							else if ((newPath->finalVertexID == referencePath->finalVertex) && (referencePath->referDFDFlag == true))
+							else if ((newPath.finalVertexID == referencePath->finalVertex) && (referencePath->referDFDFlag == true))
 							{
-								delete newPath;
 								continue;
 							}
 						}
 						else
 						{
-							double lb = calculateLowerBound(myGraph, newPath, temRecord, referencePath);
-							if ((lb != -1) && (lb < (myGraph->delta)))
+							// a path whose row is left to settleLowerBound() gets its label there
+							if (setNewPathBound(myGraph, context, temPath, &newPath, temRecord, referencePath)
+								&& ((!myGraph->labelFlag) || (!newPath.exactBoundFlag) || addPathLabel(myGraph, context, &newPath)))
 							{
-								newPath->eucDeltaOfTrue = lb;
-								newPath->eucDelta = (100000 * lb + myGraph->vertexsVector[newPath->finalVertexID].traversalOrderWeights);
-								priorityQueue.push(*newPath);
-								delete(newPath);
+								pushPath(context, newPath);
 							}
 						}
 					}
@@ -631,22 +604,17 @@ bool roadSimpleQueryPath(Graph* myGraph, ReferencePath* referencePath, std::vect
 			else
 			{
 				std::vector<Edge> finalPath;
-				for (unsigned int i = 0; i < temPath->edges.size(); i++)
-				{
-					finalPath.push_back(myGraph->edgesVector[temPath->edges[i]]);
-				}
+				getPathEdges(myGraph, context, temPath, finalPath);
 
-				double temDist = DFD(myGraph, finalPath, referencePath);
+				double temDist = DFDWithin(myGraph, finalPath, referencePath, true);
 				if (temDist <= (myGraph->delta))
 				{
-					delete firstPath;
 					lastPath = finalPath;
 					(*pathDistance) = temDist;
 					return true;
 				}
 			}
 		}
-		delete firstPath;
 		return false;
 	}
 	else
@@ -656,59 +624,65 @@ bool roadSimpleQueryPath(Graph* myGraph, ReferencePath* referencePath, std::vect
 
 }
 
-bool roadSimleQueryPathWithLoop(Graph* myGraph, ReferencePath* referencePath, std::vector<Edge> currentPath, 
+bool roadSimleQueryPathWithLoop(const Graph* myGraph, QueryContext* context, ReferencePath* referencePath, std::vector<Edge> currentPath, 
 	std::vector<Edge>& lastPath, Record* temRecord, int currentVertex, int* timeOutFlag, double* pathDistance)
 {
+	const SafeArea* area = &context->safeArea;
+	addSafeAreaVertex(myGraph, context, currentVertex);
 	clock_t startTime, stopTime;
 	startTime = clock();
-	priority_queue<TraversingPath> priorityQueue;
-	TraversingPath* firstPath = new TraversingPath;
-	initializeFirstPath(myGraph, firstPath, currentVertex, currentPath);
-	priorityQueue.push(*firstPath);
+	TraversingPath firstPath;
+	clearPathHeap(context);
+	initializeFirstPath(context, &firstPath, currentVertex, currentPath);
+	setPathDFDRow(myGraph, context, &firstPath, referencePath);
+	pushPath(context, firstPath);
 	temRecord->numOfOutPriQueue = 0;
-	while (!priorityQueue.empty())
+	while (!context->pathHeap.empty())
 	{
-		TraversingPath* temPath;
 		stopTime = clock();
 		if (((double)(stopTime - startTime) / CLOCKS_PER_SEC) > 10)
 		{
 			(*timeOutFlag) = 1;
-			delete firstPath;
 			return false;
 		}
 
-		(*temPath) = (priorityQueue.top());
-		priorityQueue.pop();
+		TraversingPath* temPath = popPath(context);
+		if (!settleLowerBound(myGraph, context, temPath, temRecord, referencePath, false))
+		{
+			continue;
+		}
 		temRecord->numOfOutPriQueue += 1;
 
-		if (temPath->edges.size() == 4990)
+		if (temPath->numOfEdge == 4990)
 		{
 			continue;
 		}
 
 		if (temPath->finalVertexID != referencePath->finalVertex)
 		{
-			for (unsigned int i = 0; i < (myGraph->vertexsVector[temPath->finalVertexID].adjVertexID.size()); i++)
+			markPathVertices(myGraph, context, temPath);
+			int localVertexID = area->localVertexID[temPath->finalVertexID];
+			for (int k = area->adjStart[localVertexID]; k < area->adjStart[localVertexID + 1]; k++)
 			{
-				int nextVertexID = myGraph->vertexsVector[temPath->finalVertexID].adjVertexID[i];
-				if (checkIfAccess(myGraph, temPath, nextVertexID))
+				int nextVertexID = area->adjacency[2 * k];
+				if (checkIfAccess(context, nextVertexID))
 				{
 
 					double maxEuc = 0;
 					double beginEuc;
 					double endEuc;
-					for (unsigned int j = myGraph->vertexsVector[nextVertexID].minPos; j <= myGraph->vertexsVector[nextVertexID].maxPos; j++)
+					for (unsigned int j = context->minPos[nextVertexID]; j <= context->maxPos[nextVertexID]; j++)
 					{
-						double x1 = myGraph->vertexsVector[nextVertexID].longitude;
-						double y1 = myGraph->vertexsVector[nextVertexID].latitude;
+						double x1 = myGraph->xOfVertex[nextVertexID];
+						double y1 = myGraph->yOfVertex[nextVertexID];
 						double x2 = referencePath->pointOfRefer[j].x;
 						double y2 = referencePath->pointOfRefer[j].y;
 						double eucDist = euc(x1, y1, x2, y2);
-						if (j == myGraph->vertexsVector[nextVertexID].minPos)
+						if (j == context->minPos[nextVertexID])
 						{
 							beginEuc = eucDist;
 						}
-						if (j == myGraph->vertexsVector[nextVertexID].maxPos)
+						if (j == context->maxPos[nextVertexID])
 						{
 							endEuc = eucDist;
 						}
@@ -722,38 +696,27 @@ bool roadSimleQueryPathWithLoop(Graph* myGraph, ReferencePath* referencePath, st
 						continue;
 					}
 
-					if ((myGraph->vertexsVector[nextVertexID].locationFlag == true))
+					TraversingPath newPath;
+					handleNewPath(myGraph, context, temPath, &newPath, nextVertexID, referencePath);
+					if (isVertexMarked(&context->referMark, newPath.finalVertexID))
 					{
-						TraversingPath* newPath = new TraversingPath;
-						handleNewPath(myGraph, temPath, newPath, nextVertexID);
-						if ((myGraph->vertexsVector[newPath->finalVertexID].referFlag == true))
+						double temDist = dfdWithinBetweenTwoPaths(myGraph, context, &newPath, referencePath, lastPath, newPath.finalVertexID);
+						if (temDist <= (myGraph->delta))
 						{
-							double temDist = dfdDistBetweenTwoPaths(myGraph, newPath, referencePath, lastPath, newPath->finalVertexID);
-							if (temDist <= (myGraph->delta))
-							{
-								delete firstPath;
-								delete newPath;
-								(*pathDistance) = temDist;
-								return true;
-							}
-							else if ((newPath->finalVertexID == referencePath->finalVertex) && (referencePath->referDFDFlag == true))
-							{
-								delete newPath;
-								continue;
-							}
+							(*pathDistance) = temDist;
+							return true;
 						}
-						else
+						else if ((newPath.finalVertexID == referencePath->finalVertex) && (referencePath->referDFDFlag == true))
 						{
-							double lb = calculateLowerBound(myGraph, newPath, temRecord, referencePath);
-							if ((lb != -1) && (lb < (myGraph->delta)))
-							{
-								newPath->eucDeltaOfTrue = lb;
-								newPath->eucDelta = (100000 * lb + myGraph->vertexsVector[newPath->finalVertexID].traversalOrderWeights);
-								priorityQueue.push(*newPath);
-								delete newPath;
-							}
+							continue;
+						}
+					}
+					else
+					{
+						if (setNewPathBound(myGraph, context, temPath, &newPath, temRecord, referencePath))
+						{
+							pushPath(context, newPath);
 						}
-
 					}
 				}
 			}
@@ -761,15 +724,10 @@ bool roadSimleQueryPathWithLoop(Graph* myGraph, ReferencePath* referencePath, st
 		else
 		{
 			std::vector<Edge> finalPath;
-			for (unsigned int i = 0; i < temPath->edges.size(); i++)
-			{
-				finalPath.push_back(myGraph->edgesVector[temPath->edges[i]]);
-			}
-			double temDist = DFD(myGraph, finalPath, referencePath);
-			
+			getPathEdges(myGraph, context, temPath, finalPath);
+			double temDist = DFDWithin(myGraph, finalPath, referencePath, true);
 			if (temDist <= (myGraph->delta))
 			{
-				delete firstPath;
 				lastPath = finalPath;
 				(*pathDistance) = temDist;
 				return true;
@@ -779,15 +737,12 @@ bool roadSimleQueryPathWithLoop(Graph* myGraph, ReferencePath* referencePath, st
 	return false;
 }
 
-void maxmalOverlapPath(Graph* myGraph, std::vector<Edge>& localPath, std::vector<Edge>& lastPath, int firstVertexID, int secVertexID, int* endVertexID)
+void maxmalOverlapPath(const Graph* myGraph, QueryContext* context, std::vector<Edge>& localPath, std::vector<Edge>& lastPath, int firstVertexID, int secVertexID, int* endVertexID)
 {
-	bool bfsFlag[(myGraph->vertexPos)];
-	bool lastPathFlag[(myGraph->vertexPos)];
-	for (unsigned int i = 0; i < myGraph->vertexPos; i++)
-	{
-		bfsFlag[i] = false;
-		lastPathFlag[i] = false;
-	}
+	VertexMark* bfsMark      = &context->searchMark;
+	VertexMark* lastPathMark = &context->lastPathMark;
+	clearVertexMark(bfsMark);
+	clearVertexMark(lastPathMark);
 	for (unsigned int i = 0; i < lastPath.size(); i++)
 	{
 		Edge temEdge = lastPath[i];
@@ -795,62 +750,60 @@ void maxmalOverlapPath(Graph* myGraph, std::vector<Edge>& localPath, std::vector
 		{
 			if (temEdge.firstVertexID == firstVertexID)
 			{
-				bfsFlag[temEdge.firstVertexID] = true;
+				setVertexMark(bfsMark, temEdge.firstVertexID);
 			}
 			else
 			{
-				bfsFlag[temEdge.secVertexID] = true;
+				setVertexMark(bfsMark, temEdge.secVertexID);
 			}
 			break;
 		}
 		else
 		{
-			bfsFlag[temEdge.firstVertexID] = true;
-			bfsFlag[temEdge.secVertexID]   = true;
+			setVertexMark(bfsMark, temEdge.firstVertexID);
+			setVertexMark(bfsMark, temEdge.secVertexID);
 		}
 	}
 	for (unsigned int i = 0; i < lastPath.size(); i++)
 	{
-		lastPathFlag[lastPath[i].firstVertexID] = true;
-		lastPathFlag[lastPath[i].secVertexID]   = true;
+		setVertexMark(lastPathMark, lastPath[i].firstVertexID);
+		setVertexMark(lastPathMark, lastPath[i].secVertexID);
 	}
-	Vertex* initVertex = new Vertex;
-	initVertex->vertexID = secVertexID;
-	std::queue<Vertex> queue;
-	queue.push(*initVertex);
+	const SafeArea* area = &context->safeArea;
+	addSafeAreaVertex(myGraph, context, secVertexID);
+	std::queue<int> queue;
+	queue.push(secVertexID);
 	while (!queue.empty())
 	{
-		Vertex temVertex = queue.front();
+		int temVertexID = queue.front();
 		queue.pop();
-		bfsFlag[temVertex.vertexID] = true;
-		if (lastPathFlag[temVertex.vertexID] == false)
+		setVertexMark(bfsMark, temVertexID);
+		if (!isVertexMarked(lastPathMark, temVertexID))
 		{
-			for (unsigned int i = 0; i < myGraph->vertexsVector[temVertex.vertexID].adjVertexID.size(); i++)
+			int localVertexID = area->localVertexID[temVertexID];
+			for (int k = area->adjStart[localVertexID]; k < area->adjStart[localVertexID + 1]; k++)
 			{
-				int nextVertexID = myGraph->vertexsVector[temVertex.vertexID].adjVertexID[i];
-				if (bfsFlag[nextVertexID] == false && myGraph->vertexsVector[nextVertexID].locationFlag == true)
+				int nextVertexID = area->adjacency[2 * k];
+				if (!isVertexMarked(bfsMark, nextVertexID))
 				{
-					bfsFlag[nextVertexID] = true;
-					Vertex* newVertex = new Vertex;
-					newVertex = &myGraph->vertexsVector[nextVertexID];
-					newVertex->parentVertexID = temVertex.vertexID;
-					queue.push(*newVertex);
+					setVertexMark(bfsMark, nextVertexID);
+					context->parentVertexID[nextVertexID] = temVertexID;
+					queue.push(nextVertexID);
 				}
 			}
 		}
 		else
 		{
-			(*endVertexID) = temVertex.vertexID;
+			(*endVertexID) = temVertexID;
 			std::vector<Edge> temPath;
-			Vertex newVertex;
-			int temID = temVertex.vertexID;
-			while (myGraph->vertexsVector[temID].vertexID != secVertexID)
+			int temID = temVertexID;
+			while (temID != secVertexID)
 			{
-				int temParentID = myGraph->vertexsVector[temID].parentVertexID;
-				temPath.push_back(findEdge(myGraph, myGraph->vertexsVector[temID], myGraph->vertexsVector[temParentID]));
+				int temParentID = context->parentVertexID[temID];
+				temPath.push_back(findEdge(myGraph, temID, temParentID));
 				temID = temParentID;
 			}
-			localPath.push_back(findEdge(myGraph, myGraph->vertexsVector[firstVertexID], myGraph->vertexsVector[secVertexID]));
+			localPath.push_back(findEdge(myGraph, firstVertexID, secVertexID));
 			for (int i = temPath.size() - 1; i >= 0; i--)
 			{
 				localPath.push_back(temPath[i]);
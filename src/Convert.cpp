@@ -0,0 +1,42 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string>
+
+#include "../include/ContinuousQuery/Base.h"
+#include "../include/ContinuousQuery/Common.h"
+#include "../include/ContinuousQuery/Construct.h"
+
+using namespace std;
+
+/**
+ * Convert the road network of a folder into the binary graph file that CTSS maps at startup
+ * argv[1] is the input folder path, nodeOSM.txt and edgeOSM.txt are read from it and graphOSM.bin is written to it
+ * argv[2] is the optional projection mode. 0:Degree coordinates (default)
+ *                                          1:Vertices projected into a local plane, delta and section length in meters
+ * argv[3] is the optional order mode. 0:Vertices and edges in the order of the input files (default)
+ *                                     1:Vertices and edges renumbered along a Hilbert curve
+ * CTSS only uses the binary graph file when it is run with the same projection mode and order mode
+*/
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		printf("Usage: %s input_folder_path [projection_mode] [order_mode]\n", argv[0]);
+		return 1;
+	}
+	string inputFolder(argv[1]);
+	bool   planarFlag  = (argc > 2) && (atoi(argv[2]) == 1);
+	bool   reorderFlag = (argc > 3) && (atoi(argv[3]) == 1);
+
+	string binPath  = inputFolder + "/graphOSM.bin";
+	string nodePath = inputFolder + "/nodeOSM.txt";
+	string edgePath = inputFolder + "/edgeOSM.txt";
+	Graph* myGraph  = new Graph;
+	readTextGraph(myGraph, nodePath, edgePath, planarFlag, reorderFlag);
+	if (!writeBinaryGraph(myGraph, binPath))
+	{
+		return 1;
+	}
+	return 0;
+}
@@ -39,6 +39,14 @@ void roadContinuousQuery(Graph* myGraph, string inputFolder, string outputFolder
  *                            3:Single point query in Road network space
  *                            4:Continuous query in Road network space
  * argv[7] is the section length
+ * argv[8] is the optional projection mode. 0:Degree coordinates (default)
+ *                                          1:Vertices projected into a local plane, delta and section length in meters
+ * argv[9] is the optional order mode. 0:Vertices and edges in the order of the input files (default)
+ *                                     1:Vertices and edges renumbered along a Hilbert curve
+ * argv[10] is the optional bound mode. 0:Lower bound of every new path calculated before it is pushed (default)
+ *                                      1:Lower bound of a new path estimated when it is pushed and calculated once it reaches the top
+ * argv[11] is the optional label mode. 0:Every path within the bounds is searched (default)
+ *                                      1:Simple path search drops paths dominated by another path at the same vertex
 */
 int main(int argc, char* argv[])
 {
@@ -49,11 +57,16 @@ int main(int argc, char* argv[])
 	int    mode          = atoi(argv[6]);
 	double delta         = atof(argv[5]);
 	double sectionLength = atof(argv[7]);
+	bool   planarFlag    = (argc > 8) && (atoi(argv[8]) == 1);
+	bool   reorderFlag   = (argc > 9) && (atoi(argv[9]) == 1);
+	bool   lazyBoundFlag = (argc > 10) && (atoi(argv[10]) == 1);
+	bool   labelFlag     = (argc > 11) && (atoi(argv[11]) == 1);
 
+	string binPath  = inputFolder + "/graphOSM.bin";
 	string nodePath = inputFolder + "/nodeOSM.txt";
 	string edgePath = inputFolder + "/edgeOSM.txt";
 	Graph* myGraph  = new Graph;
-	initializeGraph(myGraph, nodePath, edgePath, delta, sectionLength);
+	initializeGraph(myGraph, binPath, nodePath, edgePath, delta, sectionLength, planarFlag, reorderFlag, lazyBoundFlag, labelFlag);
 
 	if (mode == 1)
 	{
@@ -88,6 +101,8 @@ int main(int argc, char* argv[])
 */
 void eucSimpleQuery(Graph* myGraph, string inputFolder, string outputFolder, const int startCount, const int stopCount)
 {
+	QueryContext* context = new QueryContext;
+	initQueryContext(myGraph, context);
 	int count = startCount;
 	while (count <= stopCount)
 	{
@@ -95,7 +110,7 @@ void eucSimpleQuery(Graph* myGraph, string inputFolder, string outputFolder, con
 		string strCount = changeIntToStr(count);
 		ReferencePath* referencePath = new ReferencePath;
 		CompletePath*  completePath  = new CompletePath;
-		setQueryEnv(myGraph, referencePath, completePath, inputFolder, strCount);
+		setQueryEnv(myGraph, context, referencePath, completePath, inputFolder, strCount);
 		
 		int    currentVertex = completePath->initialVertex;
 		int    recordPos = 0;
@@ -114,11 +129,11 @@ void eucSimpleQuery(Graph* myGraph, string inputFolder, string outputFolder, con
 			}
 			
 			vector<Edge> currentPath;
-			setCurrPath(myGraph, &currentPath, completePath, i);
+			setCurrPath(context, &currentPath, completePath, i);
 			Record* temRecord = new Record;
 			
 			clock_t startTime = clock();
-			bool queryResultFlag = eucSimpleQueryPath(myGraph, referencePath, currentPath, temRecord, currentVertex);
+			bool queryResultFlag = eucSimpleQueryPath(myGraph, context, referencePath, currentPath, temRecord, currentVertex);
 			clock_t stopTime = clock();
 
 			temRecord->ratioNumEdge = ((double)(i)) / completePath->edges.size();
@@ -145,6 +160,7 @@ void eucSimpleQuery(Graph* myGraph, string inputFolder, string outputFolder, con
 		delete completePath;
 		count++;
 	}
+	delete context;
 }
 
 /**
@@ -157,6 +173,8 @@ void eucSimpleQuery(Graph* myGraph, string inputFolder, string outputFolder, con
 */
 void eucContinuousQuery(Graph* myGraph, string inputFolder, string outputFolder, const int startCount, const int stopCount)
 {
+	QueryContext* context = new QueryContext;
+	initQueryContext(myGraph, context);
 	int count = startCount;
 	while (count <= stopCount)
 	{
@@ -164,7 +182,7 @@ void eucContinuousQuery(Graph* myGraph, string inputFolder, string outputFolder,
 		string strCount = changeIntToStr(count);
 		ReferencePath* referencePath = new ReferencePath;
 		CompletePath*  completePath  = new CompletePath;
-		setQueryEnv(myGraph, referencePath, completePath, inputFolder, strCount);
+		setQueryEnv(myGraph, context, referencePath, completePath, inputFolder, strCount);
 		
 		int    currentVertex = completePath->initialVertex;
 		int    recordPos = 0;
@@ -185,7 +203,7 @@ void eucContinuousQuery(Graph* myGraph, string inputFolder, string outputFolder,
 			}
 
 			vector<Edge> currentPath;
-			setCurrPath(myGraph, &currentPath, completePath, i);
+			setCurrPath(context, &currentPath, completePath, i);
 			
 			Record* temRecord = new Record;
 			temRecord->ratioNumEdge     = ((double)(i)) / completePath->edges.size();
@@ -199,8 +217,8 @@ void eucContinuousQuery(Graph* myGraph, string inputFolder, string outputFolder,
 			record[recordPos++] = (*temRecord);
 
 			
-			double x1 = myGraph->vertexsVector[currentVertex].longitude;
-			double y1 = myGraph->vertexsVector[currentVertex].latitude;
+			double x1 = myGraph->xOfVertex[currentVertex];
+			double y1 = myGraph->yOfVertex[currentVertex];
 			double x2 = referencePath->pointOfRefer[temConQueryPos].x;
 			double y2 = referencePath->pointOfRefer[temConQueryPos].y;
 			if (euc(x1, y1, x2, y2) <= (myGraph->delta))
@@ -210,7 +228,7 @@ void eucContinuousQuery(Graph* myGraph, string inputFolder, string outputFolder,
 			else
 			{
 				temRecord->eucConQueryPos = temConQueryPos;
-				bool queryResultFlag = eucSimpleQueryPath(myGraph, referencePath, currentPath, temRecord, currentVertex);
+				bool queryResultFlag = eucSimpleQueryPath(myGraph, context, referencePath, currentPath, temRecord, currentVertex);
 				temConQueryPos = temRecord->eucConQueryPos;
 				if (queryResultFlag == false)
 				{
@@ -227,6 +245,7 @@ void eucContinuousQuery(Graph* myGraph, string inputFolder, string outputFolder,
 		delete completePath;
 		count++;
 	}
+	delete context;
 }
 
 /**
@@ -239,6 +258,8 @@ void eucContinuousQuery(Graph* myGraph, string inputFolder, string outputFolder,
 */
 void roadSimpleQuery(Graph* myGraph, string inputFolder, string outputFolder, const int startCount, const int stopCount)
 {
+	QueryContext* context = new QueryContext;
+	initQueryContext(myGraph, context);
 	int count = startCount;
 	while (count <= stopCount)
 	{
@@ -246,7 +267,7 @@ void roadSimpleQuery(Graph* myGraph, string inputFolder, string outputFolder, co
 		string strCount = changeIntToStr(count);
 		ReferencePath* referencePath = new ReferencePath;
 		CompletePath*  completePath  = new CompletePath;
-		setQueryEnv(myGraph, referencePath, completePath, inputFolder, strCount);
+		setQueryEnv(myGraph, context, referencePath, completePath, inputFolder, strCount);
 		
 		int    currentVertex = completePath->initialVertex;
 		int    recordPos = 0;
@@ -268,7 +289,7 @@ void roadSimpleQuery(Graph* myGraph, string inputFolder, string outputFolder, co
 			}
 			
 			vector<Edge> currentPath;
-			setCurrPath(myGraph, &currentPath, completePath, i);
+			setCurrPath(context, &currentPath, completePath, i);
 			
 			Record* temRecord = new Record;
 			temRecord->ratioNumEdge     = ((double)(i)) / completePath->edges.size();
@@ -282,7 +303,7 @@ void roadSimpleQuery(Graph* myGraph, string inputFolder, string outputFolder, co
 			
 			int     timeOutFlag = 0;
 			clock_t startTime = clock();
-			bool queryResultFlag = roadSimpleQueryPath(myGraph, referencePath, currentPath, temPath, temRecord, currentVertex, &timeOutFlag, &temDistance);
+			bool queryResultFlag = roadSimpleQueryPath(myGraph, context, referencePath, currentPath, temPath, temRecord, currentVertex, &timeOutFlag, &temDistance);
 			if (queryResultFlag == false)
 			{
 				if (timeOutFlag == 1)
@@ -293,7 +314,7 @@ void roadSimpleQuery(Graph* myGraph, string inputFolder, string outputFolder, co
 				else
 				{
 					timeOutFlag = 0;
-					bool queryResultFlagWithLoop = roadSimleQueryPathWithLoop(myGraph, referencePath, currentPath, temPath, temRecord, currentVertex, &timeOutFlag, &temDistance);
+					bool queryResultFlagWithLoop = roadSimleQueryPathWithLoop(myGraph, context, referencePath, currentPath, temPath, temRecord, currentVertex, &timeOutFlag, &temDistance);
 					if (queryResultFlagWithLoop == false)
 					{
 						if (timeOutFlag == 1)
@@ -336,6 +357,7 @@ void roadSimpleQuery(Graph* myGraph, string inputFolder, string outputFolder, co
 		delete completePath;
 		count++;
 	}
+	delete context;
 }
 
 /**
@@ -348,6 +370,8 @@ void roadSimpleQuery(Graph* myGraph, string inputFolder, string outputFolder, co
 */
 void roadContinuousQuery(Graph* myGraph, string inputFolder, string outputFolder, const int startCount, const int stopCount)
 {
+	QueryContext* context = new QueryContext;
+	initQueryContext(myGraph, context);
 	int count = startCount;
 	while (count <= stopCount)
 	{
@@ -355,7 +379,7 @@ void roadContinuousQuery(Graph* myGraph, string inputFolder, string outputFolder
 		string strCount = changeIntToStr(count);
 		ReferencePath* referencePath = new ReferencePath;
 		CompletePath*  completePath  = new CompletePath;
-		setQueryEnv(myGraph, referencePath, completePath, inputFolder, strCount);
+		setQueryEnv(myGraph, context, referencePath, completePath, inputFolder, strCount);
 		
 		int    currentVertex = completePath->initialVertex;
 		int    recordPos = 0;
@@ -384,7 +408,7 @@ void roadContinuousQuery(Graph* myGraph, string inputFolder, string outputFolder
 			}
 
 			vector<Edge> currentPath;
-			setCurrPath(myGraph, &currentPath, completePath, i);
+			setCurrPath(context, &currentPath, completePath, i);
 			
 			Record* temRecord = new Record;
 			temRecord->ratioNumEdge = ((double)(i)) / completePath->edges.size();
@@ -417,12 +441,12 @@ void roadContinuousQuery(Graph* myGraph, string inputFolder, string outputFolder
 					secVertexID   = currentPath[i - 1].secVertexID;
 				}													
 				vector<Edge> localPath;
-				maxmalOverlapPath(myGraph, localPath, lastPath, firstVertexID, secVertexID, &endVertexID);
+				maxmalOverlapPath(myGraph, context, localPath, lastPath, firstVertexID, secVertexID, &endVertexID);
 				if (localPath.size() == 0)
 				{
 					printf("localPath's size is 0\n");
 					int  timeOutFlag = 0;
-					bool queryResultFlag = roadSimpleQueryPath(myGraph, referencePath, currentPath, temPath, temRecord, currentVertex, &timeOutFlag, &pathDistance);
+					bool queryResultFlag = roadSimpleQueryPath(myGraph, context, referencePath, currentPath, temPath, temRecord, currentVertex, &timeOutFlag, &pathDistance);
 					if (queryResultFlag == false)
 					{
 						if (timeOutFlag == 1)
@@ -433,7 +457,7 @@ void roadContinuousQuery(Graph* myGraph, string inputFolder, string outputFolder
 						else
 						{
 							timeOutFlag = 0;
-							bool queryResultFlagWithLoop = roadSimleQueryPathWithLoop(myGraph, referencePath, currentPath, temPath, temRecord, currentVertex, &timeOutFlag, &pathDistance);
+							bool queryResultFlagWithLoop = roadSimleQueryPathWithLoop(myGraph, context, referencePath, currentPath, temPath, temRecord, currentVertex, &timeOutFlag, &pathDistance);
 							if (queryResultFlagWithLoop == false)
 							{
 								if (timeOutFlag == 1)
@@ -478,7 +502,7 @@ void roadContinuousQuery(Graph* myGraph, string inputFolder, string outputFolder
 					else
 					{
 						int  timeOutFlag = 0;
-						bool queryResultFlag = roadSimpleQueryPath(myGraph, referencePath, currentPath, temPath, temRecord, currentVertex, &timeOutFlag, &pathDistance);
+						bool queryResultFlag = roadSimpleQueryPath(myGraph, context, referencePath, currentPath, temPath, temRecord, currentVertex, &timeOutFlag, &pathDistance);
 						if (queryResultFlag == false)
 						{
 							if (timeOutFlag == 1)
@@ -489,7 +513,7 @@ void roadContinuousQuery(Graph* myGraph, string inputFolder, string outputFolder
 							else
 							{
 								timeOutFlag = 0;
-								bool queryResultFlagWithLoop = roadSimleQueryPathWithLoop(myGraph, referencePath, currentPath, temPath, temRecord, currentVertex, &timeOutFlag, &pathDistance);
+								bool queryResultFlagWithLoop = roadSimleQueryPathWithLoop(myGraph, context, referencePath, currentPath, temPath, temRecord, currentVertex, &timeOutFlag, &pathDistance);
 								if (queryResultFlagWithLoop == false)
 								{
 									if (timeOutFlag == 1)
@@ -525,4 +549,5 @@ void roadContinuousQuery(Graph* myGraph, string inputFolder, string outputFolder
 		delete completePath;
 		count++;
 	}
+	delete context;
 }